@@ -39,6 +39,7 @@ class Carimbo(ConanFile):
             "miniaudio/0.11.22",
             "physfs/3.2.0",
             "libspng/0.7.4",
+            "lz4/1.10.0",
             "sdl/3.4.0",
             "sol2/3.5.0",
             "opus/1.5.2",
@@ -0,0 +1,185 @@
+#include "actionmap.hpp"
+
+#include "input.hpp"
+#include "io.hpp"
+
+namespace {
+enum class source : uint8_t {
+  key,
+  button,
+  axis,
+};
+
+struct control final {
+  source kind;
+  int code;
+  float direction{0.0f};
+  float deadzone{0.0f};
+};
+
+struct binding final {
+  boost::container::small_vector<control, 2> chord;
+  float scale{1.0f};
+  size_t slot{0};
+};
+
+struct entry final {
+  action state;
+  boost::container::small_vector<binding, 4> bindings;
+};
+
+std::vector<entry> entries;
+boost::unordered_flat_map<std::string, size_t, transparent_string_hash, std::equal_to<>> names;
+uint64_t frames{0};
+
+constexpr auto DEADZONE = static_cast<float>(input::threshold) / 32767.0f;
+
+int resolve(const input::names& table, std::string_view name, std::string_view kind, std::string_view action) {
+  const auto it = table.find(name);
+  if (it == table.end()) [[unlikely]] {
+    throw std::runtime_error(std::format("[actionmap] unknown {} '{}' in action '{}'", kind, name, action));
+  }
+
+  return it->second;
+}
+
+binding parse(unmarshal::json node, std::string_view action) {
+  binding result;
+  result.scale = node["scale"].get(1.0f);
+  result.slot = std::min(node["slot"].get(0uz), input::slots - 1);
+
+  const auto add = [&](source kind, const input::names& table, std::string_view label, unmarshal::json value) {
+    result.chord.emplace_back(kind, resolve(table, value.get<std::string_view>(), label, action));
+  };
+
+  if (const auto key = node["key"]) {
+    add(source::key, input::keys(), "key", key);
+  }
+
+  if (const auto keys = node["keys"]) {
+    keys.foreach([&](unmarshal::json key) { add(source::key, input::keys(), "key", key); });
+  }
+
+  if (const auto button = node["button"]) {
+    add(source::button, input::buttons(), "button", button);
+  }
+
+  if (const auto buttons = node["buttons"]) {
+    buttons.foreach([&](unmarshal::json button) { add(source::button, input::buttons(), "button", button); });
+  }
+
+  if (const auto axis = node["axis"]) {
+    add(source::axis, input::axes(), "axis", axis);
+    auto& control = result.chord.back();
+    control.direction = node["direction"].get(0.0f);
+    control.deadzone = node["deadzone"].get(DEADZONE);
+  }
+
+  if (result.chord.empty()) [[unlikely]] {
+    throw std::runtime_error(std::format("[actionmap] empty binding in action '{}'", action));
+  }
+
+  return result;
+}
+
+float sample(const control& control, size_t slot) noexcept {
+  switch (control.kind) {
+    case source::key:
+      return input::down(control.code) || input::pressed(control.code) ? 1.0f : 0.0f;
+
+    case source::button: {
+      const auto& pad = input::pad(slot);
+      const auto code = static_cast<size_t>(control.code);
+      return pad.down[code] || pad.pressed[code] ? 1.0f : 0.0f;
+    }
+
+    case source::axis: {
+      const auto raw = static_cast<float>(input::pad(slot).axes[static_cast<size_t>(control.code)]) / 32767.0f;
+      const auto value = input::deadzone(std::clamp(raw, -1.0f, 1.0f), control.deadzone);
+      if (control.direction == 0.0f) {
+        return value;
+      }
+
+      return std::max(value * control.direction, 0.0f);
+    }
+  }
+
+  return 0.0f;
+}
+}
+
+void actionmap::load(std::string_view filename) {
+  entries.clear();
+  names.clear();
+
+  const auto json = unmarshal::parse(io::read(filename));
+
+  json.foreach([](std::string_view name, unmarshal::json node) {
+    entry e;
+    e.state.buffer = node["buffer"].get(uint64_t{0});
+
+    if (const auto bindings = node["bindings"]) {
+      bindings.foreach([&](unmarshal::json binding) {
+        e.bindings.emplace_back(parse(binding, name));
+      });
+    }
+
+    names.emplace(name, entries.size());
+    entries.emplace_back(std::move(e));
+  });
+
+  std::println("[actionmap] loaded {} actions from {}", entries.size(), filename);
+}
+
+void actionmap::update() {
+  ++frames;
+
+  if (entries.empty()) [[likely]] {
+    return;
+  }
+
+  const auto now = SDL_GetTicks();
+
+  for (auto& [state, bindings] : entries) {
+    auto value = 0.0f;
+    for (const auto& binding : bindings) {
+      auto product = binding.scale;
+      for (const auto& control : binding.chord) {
+        product *= sample(control, binding.slot);
+        if (product == 0.0f) {
+          break;
+        }
+      }
+
+      value += product;
+    }
+
+    const auto down = value != 0.0f;
+
+    state.value = std::clamp(value, -1.0f, 1.0f);
+    state.pressed = down && !state.down;
+    state.released = !down && state.down;
+    state.down = down;
+
+    if (state.pressed) {
+      state.since = now;
+      state.frame = frames;
+      state.expiry = now + state.buffer;
+    }
+
+    state.buffered = state.pressed || state.expiry > now;
+  }
+}
+
+action* actionmap::find(std::string_view name) noexcept {
+  const auto it = names.find(name);
+  if (it == names.end()) [[unlikely]] {
+    return nullptr;
+  }
+
+  return &entries[it->second].state;
+}
+
+uint64_t actionmap::frame() noexcept {
+  return frames;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common.hpp"
+
+struct action final {
+  bool down{false};
+  bool pressed{false};
+  bool released{false};
+  bool buffered{false};
+  float value{0.0f};
+  uint64_t since{0};
+  uint64_t frame{0};
+  uint64_t buffer{0};
+  uint64_t expiry{0};
+
+  void consume() noexcept {
+    buffered = false;
+    expiry = 0;
+  }
+};
+
+class actionmap final {
+public:
+  static void load(std::string_view filename);
+
+  static void update();
+
+  [[nodiscard]] static action* find(std::string_view name) noexcept;
+
+  [[nodiscard]] static uint64_t frame() noexcept;
+};
@@ -0,0 +1,78 @@
+#include "assetmanager.hpp"
+
+#include "pixmap.hpp"
+
+assetmanager::assetmanager(size_t budget) noexcept
+    : _budget(budget) {
+  _entries.reserve(64);
+}
+
+std::shared_ptr<pixmap> assetmanager::pixmap(std::string_view filename) {
+  return acquire(filename, [filename] {
+    auto pixmap = std::make_shared<::pixmap>(filename);
+    const auto cost = static_cast<size_t>(pixmap->width()) * static_cast<size_t>(pixmap->height()) * 4uz;
+    return std::pair{std::move(pixmap), cost};
+  });
+}
+
+bool assetmanager::contains(std::string_view path) const noexcept {
+  const auto it = _entries.find(path);
+  return it != _entries.end() && !it->second.weak.expired();
+}
+
+void assetmanager::set_budget(size_t budget) noexcept {
+  _budget = budget;
+  evict();
+}
+
+size_t assetmanager::budget() const noexcept {
+  return _budget;
+}
+
+size_t assetmanager::usage() const noexcept {
+  return _usage;
+}
+
+void assetmanager::trim() {
+  boost::unordered::erase_if(_entries, [](const auto& pair) {
+    return !pair.second.warm && pair.second.weak.expired();
+  });
+}
+
+void assetmanager::touch(const std::string& path, entry& e, std::shared_ptr<void> ptr) {
+  if (e.warm) {
+    _lru.splice(_lru.begin(), _lru, e.position);
+    return;
+  }
+
+  e.warm = std::move(ptr);
+  e.position = _lru.emplace(_lru.begin(), path);
+  _usage += e.cost;
+
+  evict();
+}
+
+void assetmanager::store(std::string_view path, std::shared_ptr<void> ptr, const std::type_info* type, size_t cost) {
+  auto [it, inserted] = _entries.try_emplace(path);
+  auto& e = it->second;
+  e.weak = ptr;
+  e.type = type;
+  e.cost = cost;
+
+  touch(it->first, e, std::move(ptr));
+}
+
+void assetmanager::evict() {
+  while (_usage > _budget && !_lru.empty()) {
+    const auto it = _entries.find(_lru.back());
+    _lru.pop_back();
+
+    auto& e = it->second;
+    e.warm.reset();
+    _usage -= e.cost;
+
+    if (e.weak.expired()) {
+      _entries.erase(it);
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common.hpp"
+
+class assetmanager final {
+public:
+  explicit assetmanager(size_t budget) noexcept;
+  ~assetmanager() noexcept = default;
+
+  assetmanager(const assetmanager&) = delete;
+  assetmanager& operator=(const assetmanager&) = delete;
+
+  template <typename F>
+  [[nodiscard]] auto acquire(std::string_view path, F&& factory) -> decltype(factory().first) {
+    using pointer = decltype(factory().first);
+    using type = typename pointer::element_type;
+
+    if (const auto it = _entries.find(path); it != _entries.end()) {
+      assert(*it->second.type == typeid(type) && "asset requested with a different type");
+
+      if (auto ptr = std::static_pointer_cast<type>(it->second.weak.lock())) [[likely]] {
+        touch(it->first, it->second, ptr);
+        return ptr;
+      }
+    }
+
+    auto [ptr, cost] = std::forward<F>(factory)();
+    store(path, ptr, &typeid(type), cost);
+    return ptr;
+  }
+
+  [[nodiscard]] std::shared_ptr<::pixmap> pixmap(std::string_view filename);
+
+  [[nodiscard]] bool contains(std::string_view path) const noexcept;
+
+  void set_budget(size_t budget) noexcept;
+
+  [[nodiscard]] size_t budget() const noexcept;
+
+  [[nodiscard]] size_t usage() const noexcept;
+
+  void trim();
+
+private:
+  struct entry final {
+    std::weak_ptr<void> weak;
+    std::shared_ptr<void> warm;
+    const std::type_info* type{nullptr};
+    size_t cost{0};
+    std::list<std::string>::iterator position;
+  };
+
+  void touch(const std::string& path, entry& e, std::shared_ptr<void> ptr);
+
+  void store(std::string_view path, std::shared_ptr<void> ptr, const std::type_info* type, size_t cost);
+
+  void evict();
+
+  size_t _budget;
+  size_t _usage{0};
+
+  std::list<std::string> _lru;
+  boost::unordered_flat_map<std::string, entry, transparent_string_hash, std::equal_to<>> _entries;
+};
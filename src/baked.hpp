@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace baked {
+static_assert(std::endian::native == std::endian::little, "baked assets are stored little endian");
+
+inline constexpr uint16_t version = 1;
+
+inline constexpr uint16_t lz4 = 1 << 0;
+inline constexpr uint16_t premultiplied = 1 << 1;
+
+inline constexpr std::array<char, 4> texture_magic{'C', 'T', 'E', 'X'};
+inline constexpr auto texture_extension = ".tex";
+
+struct texture final {
+  std::array<char, 4> magic{texture_magic};
+  uint16_t version{baked::version};
+  uint16_t flags{0};
+  uint32_t width{0};
+  uint32_t height{0};
+  uint32_t size{0};
+};
+
+static_assert(sizeof(texture) == 20);
+static_assert(std::is_trivially_copyable_v<texture>);
+
+inline constexpr std::array<char, 4> cartridge_magic{'C', 'A', 'R', 'T'};
+inline constexpr uint64_t cartridge_alignment = 4096;
+
+struct cartridge final {
+  std::array<char, 4> magic{cartridge_magic};
+  uint16_t version{baked::version};
+  uint16_t reserved{0};
+  uint32_t count{0};
+  uint32_t namesize{0};
+  uint64_t toc{0};
+};
+
+static_assert(sizeof(cartridge) == 24);
+static_assert(std::is_trivially_copyable_v<cartridge>);
+
+struct entry final {
+  uint64_t hash{0};
+  uint64_t offset{0};
+  uint32_t size{0};
+  uint32_t length{0};
+  uint32_t name{0};
+  uint16_t namelength{0};
+  uint16_t flags{0};
+};
+
+static_assert(sizeof(entry) == 32);
+static_assert(std::is_trivially_copyable_v<entry>);
+
+[[nodiscard]] constexpr uint64_t hash(std::string_view value) noexcept {
+  auto result = 0xcbf29ce484222325ull;
+  for (const auto c : value) {
+    result ^= static_cast<uint8_t>(c);
+    result *= 0x100000001b3ull;
+  }
+
+  return result;
+}
+
+inline constexpr std::array<char, 4> object_magic{'O', 'B', 'J', 'D'};
+inline constexpr std::array<char, 4> particle_magic{'P', 'A', 'R', 'T'};
+inline constexpr std::array<char, 4> tilemap_magic{'T', 'M', 'A', 'P'};
+inline constexpr auto definition_extension = ".bin";
+inline constexpr auto bytecode_extension = ".luac";
+
+struct object final {
+  std::array<char, 4> magic{object_magic};
+  uint16_t version{baked::version};
+  uint16_t reserved{0};
+  float scale{1.0f};
+  uint32_t timelines{0};
+  uint32_t frames{0};
+  uint32_t namesize{0};
+};
+
+static_assert(sizeof(object) == 24);
+
+inline constexpr uint8_t oneshot = 1 << 0;
+inline constexpr uint8_t hitbox = 1 << 1;
+
+struct timeline final {
+  uint32_t name{0};
+  uint32_t next{0};
+  uint16_t namelength{0};
+  uint16_t nextlength{0};
+  uint8_t flags{0};
+  uint8_t reserved[3]{};
+  std::array<float, 4> hitbox{};
+  uint32_t first{0};
+  uint32_t count{0};
+};
+
+static_assert(sizeof(timeline) == 40);
+
+struct frame final {
+  int32_t duration{0};
+  float offset_x{0};
+  float offset_y{0};
+  std::array<float, 4> quad{};
+};
+
+static_assert(sizeof(frame) == 28);
+
+struct particle final {
+  std::array<char, 4> magic{particle_magic};
+  uint16_t version{baked::version};
+  uint16_t reserved{0};
+  uint32_t count{0};
+  std::array<float, 2> xspawn{0, 0}, yspawn{0, 0};
+  std::array<float, 2> radius{0, 0}, angle{0, 0};
+  std::array<float, 2> scale{1, 1}, life{1, 1};
+  std::array<float, 2> xvel{0, 0}, yvel{0, 0};
+  std::array<float, 2> gx{0, 0}, gy{0, 0};
+  std::array<float, 2> rforce{0, 0}, rvel{0, 0};
+};
+
+static_assert(sizeof(particle) == 108);
+
+struct tilemap final {
+  std::array<char, 4> magic{tilemap_magic};
+  uint16_t version{baked::version};
+  uint16_t reserved{0};
+  float tile_size{0};
+  int32_t width{0};
+  int32_t height{0};
+  uint32_t layers{0};
+};
+
+static_assert(sizeof(tilemap) == 24);
+
+struct layer final {
+  uint32_t collider{0};
+  uint32_t count{0};
+};
+
+static_assert(sizeof(layer) == 8);
+
+[[nodiscard]] inline std::string sibling(std::string_view filename, std::string_view extension) {
+  const auto dot = filename.rfind('.');
+  const auto slash = filename.rfind('/');
+  const auto stem = dot != std::string_view::npos && (slash == std::string_view::npos || dot > slash) ? filename.substr(0, dot) : filename;
+
+  auto result = std::string(stem);
+  result += extension;
+  return result;
+}
+
+class reader final {
+public:
+  explicit reader(std::span<const uint8_t> data) noexcept
+      : _data(data) {}
+
+  template <typename T>
+  [[nodiscard]] T read() {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    T value;
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  void read(std::span<T> out) {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    const auto bytes = take(out.size_bytes());
+    std::memcpy(out.data(), bytes.data(), bytes.size());
+  }
+
+  [[nodiscard]] std::string_view string(size_t length) {
+    const auto bytes = take(length);
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+  }
+
+private:
+  std::span<const uint8_t> take(size_t length) {
+    if (length > _data.size()) [[unlikely]] {
+      throw std::runtime_error("[baked] unexpected end of data");
+    }
+
+    const auto result = _data.first(length);
+    _data = _data.subspan(length);
+    return result;
+  }
+
+  std::span<const uint8_t> _data;
+};
+}
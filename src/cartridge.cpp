@@ -0,0 +1,193 @@
+#include "cartridge.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+cartridge::~cartridge() noexcept {
+  if (_mapping.empty()) {
+    return;
+  }
+
+#ifdef _WIN32
+  UnmapViewOfFile(_mapping.data());
+  CloseHandle(_handle);
+  CloseHandle(_file);
+#else
+  munmap(const_cast<uint8_t*>(_mapping.data()), _mapping.size());
+#endif
+}
+
+std::unique_ptr<cartridge> cartridge::open(std::string_view filename) {
+  const auto path = std::string(filename);
+  auto result = std::unique_ptr<cartridge>(new cartridge());
+
+#ifdef _WIN32
+  auto* const file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  LARGE_INTEGER length;
+  if (!GetFileSizeEx(file, &length) || static_cast<uint64_t>(length.QuadPart) < sizeof(baked::cartridge)) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  auto* const handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!handle) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  const auto* const data = static_cast<const uint8_t*>(MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0));
+  if (!data) {
+    CloseHandle(handle);
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  result->_file = file;
+  result->_handle = handle;
+  result->_mapping = {data, static_cast<size_t>(length.QuadPart)};
+#else
+  const auto descriptor = ::open(path.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    return nullptr;
+  }
+
+  struct stat status;
+  if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) || static_cast<size_t>(status.st_size) < sizeof(baked::cartridge)) {
+    close(descriptor);
+    return nullptr;
+  }
+
+  const auto length = static_cast<size_t>(status.st_size);
+  auto* const data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  close(descriptor);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+
+  result->_mapping = {static_cast<const uint8_t*>(data), length};
+#endif
+
+  baked::cartridge header;
+  std::memcpy(&header, result->_mapping.data(), sizeof(header));
+  if (header.magic != baked::cartridge_magic) {
+    return nullptr;
+  }
+
+  if (header.version != baked::version) [[unlikely]] {
+    throw std::runtime_error(std::format("[cartridge] unsupported version {} in {}", header.version, filename));
+  }
+
+  const auto size = static_cast<uint64_t>(result->_mapping.size());
+  const auto entries = static_cast<uint64_t>(header.count) * sizeof(baked::entry);
+  if (header.toc > size || entries > size - header.toc || header.namesize > size - header.toc - entries) [[unlikely]] {
+    throw std::runtime_error(std::format("[cartridge] truncated table of contents in {}", filename));
+  }
+
+  if (header.toc % alignof(baked::entry) != 0) [[unlikely]] {
+    throw std::runtime_error(std::format("[cartridge] misaligned table of contents in {}", filename));
+  }
+
+  const auto* const toc = result->_mapping.data() + header.toc;
+  result->_entries = {reinterpret_cast<const baked::entry*>(toc), header.count};
+  result->_names = {reinterpret_cast<const char*>(toc + entries), header.namesize};
+
+  constexpr auto limit = static_cast<uint64_t>(std::numeric_limits<int>::max());
+  for (const auto& entry : result->_entries) {
+    if (entry.offset > size || entry.size > size - entry.offset) [[unlikely]] {
+      throw std::runtime_error(std::format("[cartridge] entry out of range in {}", filename));
+    }
+
+    if (entry.name > header.namesize || entry.namelength > header.namesize - entry.name) [[unlikely]] {
+      throw std::runtime_error(std::format("[cartridge] entry name out of range in {}", filename));
+    }
+
+    if ((entry.flags & baked::lz4) && (entry.size > limit || entry.length > limit)) [[unlikely]] {
+      throw std::runtime_error(std::format("[cartridge] oversized compressed entry {} in {}", result->name(entry), filename));
+    }
+  }
+
+  std::println("[cartridge] mapped {} ({} entries, {} KiB)", filename, header.count, result->_mapping.size() / 1024);
+
+  return result;
+}
+
+const baked::entry* cartridge::find(std::string_view filename) const noexcept {
+  const auto hash = baked::hash(filename);
+  auto it = std::ranges::lower_bound(_entries, hash, {}, &baked::entry::hash);
+  for (; it != _entries.end() && it->hash == hash; ++it) {
+    if (name(*it) == filename) [[likely]] {
+      return &*it;
+    }
+  }
+
+  return nullptr;
+}
+
+std::span<const uint8_t> cartridge::view(const baked::entry& entry) const noexcept {
+  if (entry.flags & baked::lz4) [[unlikely]] {
+    return {};
+  }
+
+  return _mapping.subspan(entry.offset, entry.size);
+}
+
+std::vector<uint8_t> cartridge::inflate(const baked::entry& entry) const {
+  const auto source = _mapping.subspan(entry.offset, entry.size);
+  if (!(entry.flags & baked::lz4)) {
+    return {source.begin(), source.end()};
+  }
+
+  std::vector<uint8_t> buffer(entry.length);
+  const auto written = LZ4_decompress_safe(
+    reinterpret_cast<const char*>(source.data()),
+    reinterpret_cast<char*>(buffer.data()),
+    static_cast<int>(entry.size),
+    static_cast<int>(entry.length));
+
+  if (written != static_cast<int>(entry.length)) [[unlikely]] {
+    throw std::runtime_error(std::format("[LZ4_decompress_safe] corrupted entry: {}", name(entry)));
+  }
+
+  return buffer;
+}
+
+std::vector<std::string> cartridge::enumerate(std::string_view directory) const {
+  auto prefix = std::string(directory);
+  while (!prefix.empty() && prefix.back() == '/') {
+    prefix.pop_back();
+  }
+
+  if (!prefix.empty()) {
+    prefix += '/';
+  }
+
+  std::vector<std::string> result;
+  for (const auto& entry : _entries) {
+    const auto path = name(entry);
+    if (!path.starts_with(prefix)) {
+      continue;
+    }
+
+    const auto remainder = path.substr(prefix.size());
+    const auto child = remainder.substr(0, remainder.find('/'));
+    if (std::ranges::find(result, child) == result.end()) {
+      result.emplace_back(child);
+    }
+  }
+
+  return result;
+}
+
+std::string_view cartridge::name(const baked::entry& entry) const noexcept {
+  return _names.substr(entry.name, entry.namelength);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common.hpp"
+
+#include "baked.hpp"
+
+class cartridge final {
+public:
+  ~cartridge() noexcept;
+
+  cartridge(const cartridge&) = delete;
+  cartridge& operator=(const cartridge&) = delete;
+
+  [[nodiscard]] static std::unique_ptr<cartridge> open(std::string_view filename);
+
+  [[nodiscard]] const baked::entry* find(std::string_view filename) const noexcept;
+
+  [[nodiscard]] std::span<const uint8_t> view(const baked::entry& entry) const noexcept;
+
+  [[nodiscard]] std::vector<uint8_t> inflate(const baked::entry& entry) const;
+
+  [[nodiscard]] std::vector<std::string> enumerate(std::string_view directory) const;
+
+private:
+  cartridge() noexcept = default;
+
+  [[nodiscard]] std::string_view name(const baked::entry& entry) const noexcept;
+
+  std::span<const uint8_t> _mapping;
+  std::span<const baked::entry> _entries;
+  std::string_view _names;
+
+#ifdef _WIN32
+  void* _file{nullptr};
+  void* _handle{nullptr};
+#endif
+};
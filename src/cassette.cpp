@@ -1,5 +1,7 @@
 #include "cassette.hpp"
 
+#include "baked.hpp"
+
 namespace {
 constexpr std::string_view TYPE_NULL   = "null";
 constexpr std::string_view TYPE_BOOL   = "bool";
@@ -7,7 +9,60 @@ constexpr std::string_view TYPE_INT64  = "int64";
 constexpr std::string_view TYPE_UINT64 = "uint64";
 constexpr std::string_view TYPE_DOUBLE = "double";
 constexpr std::string_view TYPE_STRING = "string";
+constexpr std::string_view TYPE_ERASE  = "erase";
+constexpr std::string_view TYPE_META   = "meta";
+
+constexpr std::string_view META_GENERATION = "generation";
+
+template <typename T>
+[[nodiscard]] constexpr T little(T value) noexcept {
+  if constexpr (std::endian::native == std::endian::big) {
+    return std::byteswap(value);
+  }
+
+  return value;
+}
+
+[[nodiscard]] uint64_t bits(std::string_view value) noexcept {
+  uint64_t result;
+  std::memcpy(&result, value.data(), sizeof(result));
+  return little(result);
+}
+
+#ifdef EMSCRIPTEN
+constexpr auto PERSIST_DELAY_MS = 250;
+
+cassette* instance{nullptr};
+#else
+constexpr auto COMPACT_THRESHOLD = 64uz * 1024uz;
+constexpr auto FLUSH_DELAY = std::chrono::milliseconds(250);
+
+constexpr std::array<char, 4> TAPE_MAGIC{'C', 'T', 'A', 'P'};
+constexpr std::array<char, 4> JOURNAL_MAGIC{'C', 'J', 'R', 'N'};
+constexpr uint16_t VERSION = 1;
+constexpr uint8_t ERASE = 0xff;
 
+struct header final {
+  std::array<char, 4> magic{};
+  uint16_t version{VERSION};
+  uint16_t reserved{0};
+  uint64_t generation{0};
+};
+
+static_assert(sizeof(header) == 16);
+
+struct record final {
+  uint64_t checksum{0};
+  uint32_t size{0};
+  uint16_t keylength{0};
+  uint8_t type{0};
+  uint8_t reserved{0};
+};
+
+static_assert(sizeof(record) == 16);
+#endif
+
+#ifdef EMSCRIPTEN
 void encode_string_to(std::string_view str, std::string& out) {
   out.reserve(out.size() + str.size());
   for (const char c : str) {
@@ -21,6 +76,149 @@ void encode_string_to(std::string_view str, std::string& out) {
   }
 }
 
+void serialize(std::string_view key, const cassette::value_type& value, std::string& buffer) {
+  std::visit([&key, &buffer](const auto& v) {
+    using T = std::decay_t<decltype(v)>;
+
+    if constexpr (std::is_same_v<T, std::nullptr_t>) {
+      std::format_to(std::back_inserter(buffer), "{}:{}=\n", TYPE_NULL, key);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_BOOL, key, v ? '1' : '0');
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+      std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_INT64, key, v);
+    } else if constexpr (std::is_same_v<T, uint64_t>) {
+      std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_UINT64, key, v);
+    } else if constexpr (std::is_same_v<T, double>) {
+      std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_DOUBLE, key, v);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      std::format_to(std::back_inserter(buffer), "{}:{}=", TYPE_STRING, key);
+      encode_string_to(v, buffer);
+      buffer.push_back('\n');
+    }
+  }, value);
+}
+#else
+void encode(std::string_view key, uint8_t type, std::string_view value, std::string& buffer) {
+  const record entry{
+    .size = little(static_cast<uint32_t>(value.size())),
+    .keylength = little(static_cast<uint16_t>(key.size())),
+    .type = type,
+  };
+
+  const auto offset = buffer.size();
+  buffer.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  buffer.append(key);
+  buffer.append(value);
+
+  const auto checksum = little(baked::hash(std::string_view(buffer).substr(offset + sizeof(entry.checksum))));
+  std::memcpy(buffer.data() + offset, &checksum, sizeof(checksum));
+}
+
+void serialize(std::string_view key, const cassette::value_type& value, std::string& buffer) {
+  const auto type = static_cast<uint8_t>(value.index());
+
+  std::visit([&](const auto& v) {
+    using T = std::decay_t<decltype(v)>;
+
+    if constexpr (std::is_same_v<T, std::nullptr_t>) {
+      encode(key, type, {}, buffer);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      const char byte = v ? 1 : 0;
+      encode(key, type, {&byte, 1}, buffer);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      encode(key, type, v, buffer);
+    } else {
+      const auto bits = little(std::bit_cast<uint64_t>(v));
+      encode(key, type, {reinterpret_cast<const char*>(&bits), sizeof(bits)}, buffer);
+    }
+  }, value);
+}
+
+std::string prologue(const std::array<char, 4>& magic, uint64_t generation) {
+  const header value{.magic = magic, .version = little(VERSION), .generation = little(generation)};
+  return {reinterpret_cast<const char*>(&value), sizeof(value)};
+}
+
+std::optional<uint64_t> generation(std::string_view content, const std::array<char, 4>& magic) {
+  if (content.size() < sizeof(header)) {
+    return std::nullopt;
+  }
+
+  header value;
+  std::memcpy(&value, content.data(), sizeof(value));
+  if (value.magic != magic || little(value.version) != VERSION) {
+    return std::nullopt;
+  }
+
+  return little(value.generation);
+}
+
+bool valid(uint8_t type, std::string_view value) noexcept {
+  switch (type) {
+    case 0: return value.empty();
+    case 1: return value.size() == 1;
+    case 2:
+    case 3:
+    case 4: return value.size() == 8;
+    case 5: return true;
+    case ERASE: return value.empty();
+    default: return false;
+  }
+}
+
+template <typename F>
+size_t scan(std::string_view content, F&& fn) {
+  auto remaining = content;
+  while (remaining.size() >= sizeof(record)) {
+    record entry;
+    std::memcpy(&entry, remaining.data(), sizeof(entry));
+    entry.checksum = little(entry.checksum);
+    entry.size = little(entry.size);
+    entry.keylength = little(entry.keylength);
+
+    const auto length = sizeof(entry) + entry.keylength + static_cast<size_t>(entry.size);
+    if (length > remaining.size()) {
+      break;
+    }
+
+    const auto bytes = remaining.substr(0, length);
+    if (baked::hash(bytes.substr(sizeof(entry.checksum))) != entry.checksum) {
+      break;
+    }
+
+    const auto key = bytes.substr(sizeof(entry), entry.keylength);
+    const auto value = bytes.substr(sizeof(entry) + entry.keylength);
+    if (!key.empty() && valid(entry.type, value)) {
+      fn(bytes, entry.type, key, value);
+    }
+
+    remaining.remove_prefix(length);
+  }
+
+  return content.size() - remaining.size();
+}
+
+bool store(const std::string& filename, std::string_view content, std::ios::openmode mode) {
+  std::ofstream file(filename, std::ios::binary | mode);
+  file.write(content.data(), static_cast<std::streamsize>(content.size()));
+  file.close();
+  return !file.fail();
+}
+
+std::string slurp(const char* filename) {
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return {};
+  }
+
+  const auto size = file.tellg();
+  file.seekg(0);
+  std::string content(static_cast<std::size_t>(size), '\0');
+  file.read(content.data(), size);
+  return content;
+}
+#endif
+
 std::string decode_string(std::string_view str) {
   if (str.find('\\') == std::string_view::npos) [[likely]] {
     return std::string(str);
@@ -66,132 +264,357 @@ bool parse(std::string_view line, std::string_view& type, std::string_view& key,
   value = line.substr(e + 1);
   return !key.empty();
 }
-}
 
-cassette::cassette() {
-#ifdef EMSCRIPTEN
-  const auto* const result = emscripten_run_script_string(std::format("localStorage.getItem('{}')", _storagekey).c_str());
-  const std::string content{result ? result : ""};
-
-  if (content.empty() || content == "null") {
-    return;
-  }
-#else
-  if (!std::filesystem::exists(_filename)) {
-    return;
+#ifndef EMSCRIPTEN
+std::optional<uint64_t> textgeneration(std::string_view content) {
+  std::string_view type, key, value;
+  if (!parse(content.substr(0, content.find('\n')), type, key, value) || type != TYPE_META || key != META_GENERATION) {
+    return std::nullopt;
   }
 
-  std::ifstream file(_filename, std::ios::binary | std::ios::ate);
-  if (!file) {
-    return;
+  uint64_t result{};
+  if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result); ec != std::errc{}) {
+    return std::nullopt;
   }
 
-  const auto size = file.tellg();
-  file.seekg(0);
-  std::string content(static_cast<std::size_t>(size), '\0');
-  file.read(content.data(), size);
+  return result;
+}
 #endif
 
+template <typename Map>
+void replay(std::string_view content, Map& data) {
   std::string_view remaining{content};
   while (!remaining.empty()) {
     const auto newline_pos = remaining.find('\n');
-    const auto line = remaining.substr(0, newline_pos);
-    remaining = (newline_pos == std::string_view::npos) ? std::string_view{} : remaining.substr(newline_pos + 1);
-
-    if (line.empty()) {
-      continue;
+    if (newline_pos == std::string_view::npos) {
+      break;
     }
 
+    const auto line = remaining.substr(0, newline_pos);
+    remaining = remaining.substr(newline_pos + 1);
+
     std::string_view type;
     std::string_view key, value;
     if (!parse(line, type, key, value)) {
       continue;
     }
 
-    if (type == TYPE_NULL) {
-      _data.try_emplace(key, nullptr);
+    if (type == TYPE_ERASE) {
+      data.erase(key);
+    } else if (type == TYPE_NULL) {
+      data.insert_or_assign(key, nullptr);
     } else if (type == TYPE_BOOL) {
-      _data.try_emplace(key, value == "1");
+      data.insert_or_assign(key, value == "1");
     } else if (type == TYPE_INT64) {
       int64_t v{};
       if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), v); ec == std::errc{}) {
-        _data.try_emplace(key, v);
+        data.insert_or_assign(key, v);
       }
     } else if (type == TYPE_UINT64) {
       uint64_t v{};
       if (auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), v); ec == std::errc{}) {
-        _data.try_emplace(key, v);
+        data.insert_or_assign(key, v);
       }
     } else if (type == TYPE_DOUBLE) {
       char* end{};
       const auto v = std::strtod(value.data(), &end);
       if (end != value.data() && end == value.data() + value.size()) {
-        _data.try_emplace(key, v);
+        data.insert_or_assign(key, v);
       }
     } else if (type == TYPE_STRING) {
-      _data.try_emplace(key, decode_string(value));
+      data.insert_or_assign(key, decode_string(value));
     }
   }
 }
+}
 
-void cassette::persist() const {
+static_assert(std::is_same_v<std::variant_alternative_t<5, cassette::value_type>, std::string>);
+
+cassette::cassette() {
+#ifdef EMSCRIPTEN
+  instance = this;
+
+  const auto* const result = emscripten_run_script_string(std::format("localStorage.getItem('{}')", _storagekey).c_str());
+  const std::string content{result ? result : ""};
+
+  if (content.empty() || content == "null") {
+    return;
+  }
+
+  replay(content, _data);
+#else
+  _tape = slurp(_filename);
+  const auto journal = slurp(_journalname);
+
+  const auto binary = _tape.starts_with(std::string_view(TAPE_MAGIC.data(), TAPE_MAGIC.size()));
+  if (!_tape.empty() && !binary) {
+    _generation = textgeneration(_tape).value_or(0);
+    replay(_tape, _data);
+    if (textgeneration(journal) == _generation) {
+      replay(journal, _data);
+    }
+
+    std::println("[cassette] migrating {} keys from the text format", _data.size());
+
+    _tape.clear();
+    compact();
+  } else {
+    if (binary && !generation(_tape, TAPE_MAGIC)) [[unlikely]] {
+      std::println(stderr, "[cassette] unsupported version in {}, starting empty without saving", _filename);
+      _tape.clear();
+      _readonly = true;
+      return;
+    }
+
+    _generation = generation(_tape, TAPE_MAGIC).value_or(0);
+    _snapshotsize = _tape.size();
+
+    if (!_tape.empty()) {
+      const auto body = std::string_view(_tape).substr(sizeof(header));
+      const auto consumed = scan(body, [this](std::string_view bytes, uint8_t type, std::string_view key, std::string_view value) {
+        if (type != ERASE) {
+          _index.insert_or_assign(key, entry{bytes, type, value});
+        }
+      });
+
+      if (consumed != body.size()) [[unlikely]] {
+        std::println(stderr, "[cassette] {} is corrupted after {} bytes", _filename, consumed);
+      }
+    }
+
+    if (generation(journal, JOURNAL_MAGIC) == _generation) {
+      _journalsize = journal.size();
+
+      const auto body = std::string_view(journal).substr(sizeof(header));
+      const auto consumed = scan(body, [this](std::string_view, uint8_t type, std::string_view key, std::string_view value) {
+        _index.erase(key);
+        if (type == ERASE) {
+          _data.erase(key);
+        } else {
+          _data.insert_or_assign(key, decode(entry{{}, type, value}));
+        }
+      });
+
+      if (consumed != body.size()) {
+        compact();
+      }
+    } else {
+      _journal = prologue(JOURNAL_MAGIC, _generation);
+      _truncate = true;
+    }
+  }
+
+  _thread = std::jthread([this](std::stop_token token) { run(token); });
+#endif
+}
+
+cassette::~cassette() noexcept {
+#ifdef EMSCRIPTEN
+  if (_scheduled) {
+    persist();
+  }
+
+  if (instance == this) {
+    instance = nullptr;
+  }
+#else
+  _thread.request_stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+#endif
+}
+
+cassette::value_type cassette::decode(const entry& slot) {
+  switch (slot.type) {
+    case 1:
+      return slot.value.front() != 0;
+    case 2:
+      return std::bit_cast<int64_t>(bits(slot.value));
+    case 3:
+      return bits(slot.value);
+    case 4:
+      return std::bit_cast<double>(bits(slot.value));
+    case string_type:
+      return std::string(slot.value);
+    default:
+      return nullptr;
+  }
+}
+
+std::string cassette::snapshot() const {
   std::string buffer;
-  buffer.reserve(_data.size() * 64);
+  buffer.reserve(_data.size() * 64 + _tape.size());
+
+#ifndef EMSCRIPTEN
+  buffer = prologue(TAPE_MAGIC, _generation);
+
+  for (const auto& [key, slot] : _index) {
+    buffer.append(slot.record);
+  }
+#endif
 
   for (const auto& [key, value] : _data) {
-    std::visit([&key, &buffer](const auto& v) {
-      using T = std::decay_t<decltype(v)>;
-
-      if constexpr (std::is_same_v<T, std::nullptr_t>) {
-        std::format_to(std::back_inserter(buffer), "{}:{}=\n", TYPE_NULL, key);
-      } else if constexpr (std::is_same_v<T, bool>) {
-        std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_BOOL, key, v ? '1' : '0');
-      } else if constexpr (std::is_same_v<T, int64_t>) {
-        std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_INT64, key, v);
-      } else if constexpr (std::is_same_v<T, uint64_t>) {
-        std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_UINT64, key, v);
-      } else if constexpr (std::is_same_v<T, double>) {
-        std::format_to(std::back_inserter(buffer), "{}:{}={}\n", TYPE_DOUBLE, key, v);
-      } else if constexpr (std::is_same_v<T, std::string>) {
-        std::format_to(std::back_inserter(buffer), "{}:{}=", TYPE_STRING, key);
-        encode_string_to(v, buffer);
-        buffer.push_back('\n');
-      }
-    }, value);
+    serialize(key, value, buffer);
   }
 
+  return buffer;
+}
+
+void cassette::record(std::string_view key) {
+  _index.erase(key);
+
 #ifdef EMSCRIPTEN
+  compact();
+#else
+  std::string bytes;
+  if (const auto it = _data.find(key); it != _data.end()) {
+    serialize(it->first, it->second, bytes);
+  } else {
+    encode(key, ERASE, {}, bytes);
+  }
+
+  append(std::move(bytes));
+#endif
+}
+
+#ifdef EMSCRIPTEN
+void cassette::compact() {
+  if (_scheduled) {
+    return;
+  }
+
+  _scheduled = true;
+  emscripten_async_call([](void* userdata) {
+    auto* const self = static_cast<cassette*>(userdata);
+    if (self != instance) [[unlikely]] {
+      return;
+    }
+
+    self->_scheduled = false;
+    self->persist();
+  }, this, PERSIST_DELAY_MS);
+}
+
+void cassette::persist() const {
+  const auto buffer = snapshot();
+
   std::string script;
   script.reserve(buffer.size() + 128);
   std::format_to(std::back_inserter(script), "localStorage.setItem('{}', '", _storagekey);
   encode_string_to(buffer, script);
   script.append("')");
   emscripten_run_script(script.c_str());
+}
 #else
-  std::ofstream file(_filename, std::ios::binary | std::ios::trunc);
-  file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-#endif
+void cassette::append(std::string&& bytes) {
+  if (_readonly) [[unlikely]] {
+    return;
+  }
+
+  _journalsize += bytes.size();
+  if (_journalsize > std::max(COMPACT_THRESHOLD, _snapshotsize * 2)) {
+    compact();
+    return;
+  }
+
+  {
+    std::lock_guard lock(_mutex);
+    _journal += bytes;
+  }
+
+  _condition.notify_one();
+}
+
+void cassette::compact() {
+  if (_readonly) [[unlikely]] {
+    return;
+  }
+
+  ++_generation;
+
+  auto content = snapshot();
+  _snapshotsize = content.size();
+  _journalsize = 0;
+
+  {
+    std::lock_guard lock(_mutex);
+    _snapshot = std::move(content);
+    _journal = prologue(JOURNAL_MAGIC, _generation);
+    _truncate = true;
+  }
+
+  _condition.notify_one();
 }
 
+void cassette::run(std::stop_token token) {
+  std::unique_lock lock(_mutex);
+  while (_condition.wait(lock, token, [this] { return _snapshot.has_value() || !_journal.empty(); })) {
+    _condition.wait_for(lock, token, FLUSH_DELAY, [] { return false; });
+
+    auto snapshot = std::exchange(_snapshot, std::nullopt);
+    const auto journal = std::exchange(_journal, {});
+    const auto truncate = std::exchange(_truncate, false);
+    lock.unlock();
+
+    auto flushed = true;
+    if (snapshot) {
+      const auto temporary = std::format("{}.tmp", _filename);
+      std::error_code error;
+      if (!store(temporary, *snapshot, std::ios::trunc)) [[unlikely]] {
+        std::println(stderr, "[cassette] failed to write {}", temporary);
+        flushed = false;
+      } else if (std::filesystem::rename(temporary, _filename, error); error) [[unlikely]] {
+        std::println(stderr, "[cassette] failed to replace {}: {}", _filename, error.message());
+        flushed = false;
+      }
+    }
+
+    if (flushed && !store(_journalname, journal, truncate ? std::ios::trunc : std::ios::app)) [[unlikely]] {
+      std::println(stderr, "[cassette] failed to write {}", _journalname);
+      flushed = false;
+    }
+
+    lock.lock();
+
+    if (!flushed && !_snapshot) {
+      _snapshot = std::move(snapshot);
+      _journal.insert(0, journal);
+      _truncate = _truncate || truncate;
+    }
+  }
+}
+#endif
+
 void cassette::clear(std::string_view key) {
   if (key.empty()) [[unlikely]] {
     return;
   }
 
-  _data.erase(key);
-  persist();
+  const auto erased = _data.erase(key) + _index.erase(key);
+  if (erased == 0) {
+    return;
+  }
+
+  record(key);
 }
 
 void cassette::clear() {
   _data.clear();
-  persist();
+  _index.clear();
+  _tape = {};
+  compact();
 }
 
 std::optional<cassette::value_type> cassette::find(std::string_view key) const noexcept {
-  const auto it = _data.find(key);
-  if (it == _data.end()) {
+  if (const auto it = _data.find(key); it != _data.end()) {
+    return it->second;
+  }
+
+  const auto it = _index.find(key);
+  if (it == _index.end()) {
     return std::nullopt;
   }
 
-  return it->second;
+  return decode(it->second);
 }
@@ -16,11 +16,14 @@ public:
   >;
 
   cassette();
-  ~cassette() noexcept = default;
+  ~cassette() noexcept;
+
+  cassette(const cassette&) = delete;
+  cassette& operator=(const cassette&) = delete;
 
   template<typename T>
   void set(std::string_view key, const T& value) {
-    if (key.empty()) [[unlikely]] {
+    if (key.empty() || key.size() > std::numeric_limits<uint16_t>::max()) [[unlikely]] {
       return;
     }
 
@@ -40,18 +43,49 @@ public:
       static_assert(sizeof(T) == 0, "unsupported type for cassette::set");
     }
 
-    persist();
+    record(key);
   }
 
   template<typename T>
   T get(std::string_view key, const T& fallback) const {
-    const auto it = _data.find(key);
-    if (it == _data.end()) {
+    if (const auto it = _data.find(key); it != _data.end()) {
+      return convert(it->second, fallback);
+    }
+
+    const auto it = _index.find(key);
+    if (it == _index.end()) {
       return fallback;
     }
 
-    const auto& storage = it->second;
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      if (it->second.type == string_type) {
+        return it->second.value;
+      }
+
+      return fallback;
+    } else {
+      return convert(decode(it->second), fallback);
+    }
+  }
+
+  void clear(std::string_view key);
+  void clear();
+
+  std::optional<value_type> find(std::string_view key) const noexcept;
+
+private:
+  struct entry final {
+    std::string_view record;
+    uint8_t type;
+    std::string_view value;
+  };
+
+  static constexpr uint8_t string_type = 5;
+
+  [[nodiscard]] static value_type decode(const entry& slot);
 
+  template<typename T>
+  static T convert(const value_type& storage, const T& fallback) {
     if constexpr (std::is_same_v<T, bool>) {
       if (const auto* v = std::get_if<bool>(&storage)) {
         return *v;
@@ -99,19 +133,40 @@ public:
     return fallback;
   }
 
-  void clear(std::string_view key);
-  void clear();
-
-  std::optional<value_type> find(std::string_view key) const noexcept;
-
-private:
   boost::unordered_flat_map<std::string, value_type, transparent_string_hash, std::equal_to<>> _data;
+  boost::unordered_flat_map<std::string_view, entry, transparent_string_hash, std::equal_to<>> _index;
+  std::string _tape;
+  uint64_t _generation{0};
 
 #ifndef EMSCRIPTEN
   static constexpr const char* _filename = "cassette.tape";
+  static constexpr const char* _journalname = "cassette.journal";
+
+  size_t _snapshotsize{0};
+  size_t _journalsize{0};
+
+  std::mutex _mutex;
+  std::condition_variable_any _condition;
+  std::string _journal;
+  std::optional<std::string> _snapshot;
+  bool _truncate{false};
+  bool _readonly{false};
+  std::jthread _thread;
+
+  void append(std::string&& bytes);
+
+  void run(std::stop_token token);
 #else
   static constexpr const char* _storagekey = "cassette";
-#endif
+
+  bool _scheduled{false};
 
   void persist() const;
+#endif
+
+  [[nodiscard]] std::string snapshot() const;
+
+  void record(std::string_view key);
+
+  void compact();
 };
@@ -16,6 +16,7 @@
 #include <box2d/box2d.h>
 #include <entt/entt.hpp>
 #include <lua.hpp>
+#include <lz4.h>
 #include <physfs.h>
 #include <SDL3/SDL.h>
 #include <spng.h>
@@ -25,6 +26,7 @@
 #include <boost/container/small_vector.hpp>
 #include <boost/static_string.hpp>
 #include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
 
 #ifdef HAS_SENTRY
 #include <sentry.h>
@@ -38,16 +40,23 @@
 #include <array>
 #include <atomic>
 #include <bit>
+#include <bitset>
 #include <charconv>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 #include <format>
+#include <forward_list>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <limits>
+#include <list>
 #include <map>
 #include <memory>
 #include <memory_resource>
@@ -55,6 +64,7 @@
 #include <numbers>
 #include <optional>
 #include <print>
+#include <queue>
 #include <random>
 #include <ranges>
 #include <span>
@@ -62,6 +72,7 @@
 #include <source_location>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
@@ -80,7 +91,9 @@ struct vec2;
 #include "unmarshal.hpp"
 
 class application;
+class assetmanager;
 class canvas;
+class cartridge;
 class cassette;
 class color;
 class cursor;
@@ -1,6 +1,7 @@
 #include "components.hpp"
 
 #include "objectproxy.hpp"
+#include "stopwatch.hpp"
 
 interning::counter::counter() {
   _counters.reserve(8);
@@ -12,7 +13,6 @@ uint32_t interning::counter::operator()(symbol id) {
 
 interning::interning() {
   _symbols.reserve(64);
-  _bytecodes.reserve(128);
 }
 
 symbol interning::intern(std::string_view value) {
@@ -28,41 +28,33 @@ std::string_view interning::lookup(symbol id) const noexcept {
   return it->second;
 }
 
-void scripting::wire(entt::entity entity, sol::environment& parent, std::shared_ptr<objectproxy> proxy, std::string_view filename) {
-  if (!io::exists(filename)) return;
-
-  auto& interning = _registry.ctx().get<::interning>();
-  const auto id = interning.intern(filename);
-  const auto code = interning.bytecode(id, [&] {
-    const auto buffer = io::read(filename);
-    std::string_view script{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
-    sol::state_view lua(parent.lua_state());
-    const auto result = lua.load(script, std::format("@{}", filename));
-
-    verify(result);
+symbol interning::claim(std::string_view name) {
+  const auto id = intern(name);
+  _names.emplace(id);
+  return id;
+}
 
-    auto function = result.get<sol::protected_function>();
+symbol interning::unique(std::string_view prefix, symbol id) {
+  const std::string base{prefix};
+  while (true) {
+    const auto candidate = intern(std::format("{}_{}", base, increment(id)));
+    if (_names.emplace(candidate).second) [[likely]] {
+      return candidate;
+    }
+  }
+}
 
-    std::string bytecode;
-    bytecode.reserve(buffer.size() * 7 / 2);
-    function.push();
-    lua_dump(lua.lua_state(), [](lua_State*, const void* data, size_t size, void* userdata) -> int {
-      static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
-      return 0;
-    }, &bytecode, 0);
-    lua_pop(lua.lua_state(), 1);
+void scripting::derive(entt::entity entity, sol::environment& parent, const objectproxy& proxy, std::shared_ptr<const std::string> bytecode, symbol chunkname) {
+  if (const auto it = _prototypes.find(chunkname); it != _prototypes.end()) {
+    attach(entity, parent, proxy, it->second, std::move(bytecode), chunkname);
+    return;
+  }
 
-    return std::make_shared<const std::string>(std::move(bytecode));
-  });
+  assert(bytecode && "derive requires bytecode for uncached scripts");
 
-  derive(entity, parent, proxy, code, id);
-}
-
-void scripting::derive(entt::entity entity, sol::environment& parent, std::shared_ptr<objectproxy> proxy, std::shared_ptr<const std::string> bytecode, symbol chunkname) {
   const auto& interning = _registry.ctx().get<::interning>();
   sol::state_view lua(parent.lua_state());
   sol::environment environment(lua, sol::create, parent);
-  environment["self"] = proxy;
 
   const auto result = lua.load(*bytecode, std::format("@{}", interning.lookup(chunkname)));
   verify(result);
@@ -70,73 +62,146 @@ void scripting::derive(entt::entity entity, sol::environment& parent, std::share
   auto function = result.get<sol::protected_function>();
   sol::set_environment(environment, function);
 
-  const auto exec = function();
+  const sol::table inherit = environment[sol::metatable_key];
+  auto touched = false;
+  environment[sol::metatable_key] = lua.create_table_with(
+    sol::meta_function::index, [&touched, &parent, &proxy](const sol::table&, const sol::object& key, sol::this_state state) -> sol::object {
+      if (key.get_type() == sol::type::string && key.as<std::string_view>() == "self") {
+        touched = true;
+        return sol::make_object(state, proxy);
+      }
+
+      return parent.get<sol::object>(key);
+    }
+  );
+
+  const auto exec = stopwatch::measure(stage::execute, interning.lookup(chunkname), [&] { return function(); });
+  environment[sol::metatable_key] = inherit;
   verify(exec);
 
-  auto module = exec.get<sol::table>();
+  auto proto = std::make_shared<prototype>();
+  proto->environment = environment;
+  proto->module = exec.get<sol::table>();
+  proto->shared = proto->module["prototype"].get_or(false);
 
-  scriptable sc;
-  sc.parent = parent;
-  sc.environment = environment;
-  sc.module = module;
-  sc.bytecode = std::move(bytecode);
-  sc.chunkname = chunkname;
+  if (proto->shared && touched) [[unlikely]] {
+    throw std::runtime_error(std::format("[scripting] prototype module {} reads self at the top level", interning.lookup(chunkname)));
+  }
 
-  if (auto fn = module["on_spawn"].get<sol::protected_function>(); fn.valid()) {
-    sc.on_spawn = std::move(fn);
+  if (!proto->shared) {
+    environment["self"] = proxy;
   }
 
-  if (auto fn = module["on_dispose"].get<sol::protected_function>(); fn.valid()) {
-    sc.on_dispose = std::move(fn);
+  boost::container::small_vector<std::pair<std::string_view, sol::protected_function>, 16> callbacks;
+  proto->module.for_each([&](const sol::object& key, const sol::object& value) {
+    if (key.get_type() != sol::type::string || value.get_type() != sol::type::function) {
+      return;
+    }
+
+    const auto name = key.as<std::string_view>();
+    if (!name.starts_with("on_")) {
+      return;
+    }
+
+    callbacks.emplace_back(name, value.as<sol::protected_function>());
+  });
+
+  for (const auto& [name, fn] : callbacks) {
+    if (proto->shared) {
+      proto->methods.emplace(name.substr(3), sol::make_object(lua, fn));
+      continue;
+    }
+
+    proto->methods.emplace(name.substr(3), sol::make_object(lua, [fn](sol::variadic_args va) { return fn(va); }));
   }
 
-  if (auto fn = module["on_loop"].get<sol::protected_function>(); fn.valid()) {
-    sc.on_loop = std::move(fn);
+  const auto& module = proto->module;
+  proto->on_spawn = module["on_spawn"].get<sol::protected_function>();
+  proto->on_dispose = module["on_dispose"].get<sol::protected_function>();
+  proto->on_loop = module["on_loop"].get<sol::protected_function>();
+  proto->on_begin = module["on_begin"].get<sol::protected_function>();
+  proto->on_end = module["on_end"].get<sol::protected_function>();
+  proto->on_collision = module["on_collision"].get<sol::protected_function>();
+  proto->on_collision_end = module["on_collision_end"].get<sol::protected_function>();
+  proto->on_hover = module["on_hover"].get<sol::protected_function>();
+  proto->on_unhover = module["on_unhover"].get<sol::protected_function>();
+  proto->on_touch = module["on_touch"].get<sol::protected_function>();
+  proto->on_screen_exit = module["on_screen_exit"].get<sol::protected_function>();
+  proto->on_screen_enter = module["on_screen_enter"].get<sol::protected_function>();
+  proto->on_appear = module["on_appear"].get<sol::protected_function>();
+  proto->on_disappear = module["on_disappear"].get<sol::protected_function>();
+
+  if (proto->shared) {
+    _prototypes.emplace(chunkname, proto);
   }
 
-  if (auto on_begin = module["on_begin"].get<sol::protected_function>(),
-         on_end = module["on_end"].get<sol::protected_function>();
-      on_begin.valid() || on_end.valid()) {
+  attach(entity, parent, proxy, std::move(proto), std::move(bytecode), chunkname);
+}
+
+void scripting::attach(entt::entity entity, sol::environment& parent, const objectproxy& proxy, std::shared_ptr<const ::prototype> proto, std::shared_ptr<const std::string> bytecode, symbol chunkname) {
+  const auto receiver = proto->shared ? sol::make_object(parent.lua_state(), proxy) : sol::object();
+  const auto bind = [&](const sol::protected_function& fn) {
+    return functor{fn, receiver};
+  };
+
+  if (proto->on_begin.valid() || proto->on_end.valid()) {
     auto& a = _registry.emplace<animatable>(entity);
-    a.on_begin = std::move(on_begin);
-    a.on_end = std::move(on_end);
+    a.on_begin = bind(proto->on_begin);
+    a.on_end = bind(proto->on_end);
   }
 
-  if (auto on_collision = module["on_collision"].get<sol::protected_function>(),
-         on_collision_end = module["on_collision_end"].get<sol::protected_function>();
-      on_collision.valid() || on_collision_end.valid()) {
+  if (proto->on_collision.valid() || proto->on_collision_end.valid()) {
     auto& c = _registry.emplace<collidable>(entity);
-    c.on_collision = std::move(on_collision);
-    c.on_collision_end = std::move(on_collision_end);
+    c.on_collision = bind(proto->on_collision);
+    c.on_collision_end = bind(proto->on_collision_end);
   }
 
-  if (auto on_hover = module["on_hover"].get<sol::protected_function>(),
-         on_unhover = module["on_unhover"].get<sol::protected_function>();
-      on_hover.valid() || on_unhover.valid()) {
+  if (proto->on_hover.valid() || proto->on_unhover.valid()) {
     auto& h = _registry.emplace<hoverable>(entity);
-    h.on_hover = std::move(on_hover);
-    h.on_unhover = std::move(on_unhover);
+    h.on_hover = bind(proto->on_hover);
+    h.on_unhover = bind(proto->on_unhover);
   }
 
-  if (auto fn = module["on_touch"].get<sol::protected_function>(); fn.valid()) {
-    _registry.emplace<touchable>(entity, std::move(fn));
+  if (proto->on_touch.valid()) {
+    _registry.emplace<touchable>(entity, bind(proto->on_touch));
   }
 
-  if (auto on_screen_exit = module["on_screen_exit"].get<sol::protected_function>(),
-         on_screen_enter = module["on_screen_enter"].get<sol::protected_function>();
-      on_screen_exit.valid() || on_screen_enter.valid()) {
+  if (proto->on_screen_exit.valid() || proto->on_screen_enter.valid()) {
     auto& sb = _registry.emplace<screenboundable>(entity);
-    sb.on_screen_exit = std::move(on_screen_exit);
-    sb.on_screen_enter = std::move(on_screen_enter);
+    sb.on_screen_exit = bind(proto->on_screen_exit);
+    sb.on_screen_enter = bind(proto->on_screen_enter);
   }
 
-  if (auto on_appear = module["on_appear"].get<sol::protected_function>(),
-         on_disappear = module["on_disappear"].get<sol::protected_function>();
-      on_appear.valid() || on_disappear.valid()) {
+  if (proto->on_appear.valid() || proto->on_disappear.valid()) {
     auto& a = _registry.emplace<appearable>(entity);
-    a.on_appear = std::move(on_appear);
-    a.on_disappear = std::move(on_disappear);
+    a.on_appear = bind(proto->on_appear);
+    a.on_disappear = bind(proto->on_disappear);
   }
 
+  scriptable sc;
+  sc.parent = parent;
+  sc.on_spawn = bind(proto->on_spawn);
+  sc.on_dispose = bind(proto->on_dispose);
+  sc.on_loop = bind(proto->on_loop);
+  sc.prototype = std::move(proto);
+  sc.bytecode = std::move(bytecode);
+  sc.chunkname = chunkname;
+
   _registry.emplace<scriptable>(entity, std::move(sc));
 }
+
+void scripting::spawn(entt::entity entity) {
+  auto* sc = _registry.try_get<scriptable>(entity);
+  if (!sc || sc->spawned) return;
+
+  sc->spawned = true;
+  sc->on_spawn();
+}
+
+void scripting::dispose(entt::entity entity) {
+  auto* sc = _registry.try_get<scriptable>(entity);
+  if (!sc || !sc->spawned) return;
+
+  sc->spawned = false;
+  sc->on_dispose();
+}
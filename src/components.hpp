@@ -2,6 +2,7 @@
 
 #include "common.hpp"
 
+#include "baked.hpp"
 #include "geometry.hpp"
 #include "flip.hpp"
 
@@ -26,18 +27,14 @@ public:
   [[nodiscard]] symbol intern(std::string_view value);
   [[nodiscard]] std::string_view lookup(symbol id) const noexcept;
 
-  template <typename F>
-  [[nodiscard]] std::shared_ptr<const std::string> bytecode(symbol id, F&& factory) {
-    auto [it, inserted] = _bytecodes.try_emplace(id, nullptr);
-    if (inserted) it->second = factory();
-    return it->second;
-  }
+  [[nodiscard]] symbol claim(std::string_view name);
+  [[nodiscard]] symbol unique(std::string_view prefix, symbol id);
 
   counter increment;
 
 private:
   boost::unordered_flat_map<symbol, std::string> _symbols{{empty, {}}};
-  boost::unordered_flat_map<symbol, std::shared_ptr<const std::string>> _bytecodes;
+  boost::unordered_flat_set<symbol> _names;
 };
 
 struct transform final {
@@ -74,6 +71,12 @@ struct frame final {
         offset_x(node["offset"]["x"].get(0.f)),
         offset_y(node["offset"]["y"].get(0.f)),
         quad(node["quad"].get<::quad>()) {}
+
+  frame(const baked::frame& record) noexcept
+      : duration(record.duration),
+        offset_x(record.offset_x),
+        offset_y(record.offset_y),
+        quad(record.quad) {}
 };
 
 struct timeline final {
@@ -220,15 +223,105 @@ struct appearable {
   functor on_disappear;
 };
 
-struct scriptable {
-  sol::environment parent;
+struct dormant final {};
+
+struct incarnation final {
+  uint32_t generation{0};
+};
+
+static_assert(std::is_trivially_copyable_v<incarnation>);
+
+enum class easing : uint8_t {
+  linear,
+  quadin,
+  quadout,
+  quadinout,
+  cubicin,
+  cubicout,
+  cubicinout,
+  sinein,
+  sineout,
+  sineinout,
+  backout,
+  bounceout,
+};
+
+struct tweenable final {
+  enum class property : uint8_t {
+    x,
+    y,
+    alpha,
+    scale,
+    angle,
+  };
+
+  struct track final {
+    property target;
+    float from{0};
+    float to{0};
+  };
+
+  struct step final {
+    boost::container::small_vector<track, 2> tracks;
+    uint64_t duration{0};
+    easing curve{easing::linear};
+    functor on_complete;
+    uint64_t start{0};
+    bool started{false};
+  };
+
+  std::deque<step> steps;
+};
+
+struct recycler final {
+  boost::unordered_flat_map<symbol, std::vector<entt::entity>> entities;
+
+  [[nodiscard]] entt::entity acquire(symbol kind) noexcept {
+    const auto it = entities.find(kind);
+    if (it == entities.end() || it->second.empty()) {
+      return entt::null;
+    }
+
+    const auto entity = it->second.back();
+    it->second.pop_back();
+    return entity;
+  }
+
+  void release(symbol kind, entt::entity entity) {
+    entities[kind].push_back(entity);
+  }
+};
+
+struct prototype final {
   sol::environment environment;
   sol::table module;
+  bool shared{false};
+  boost::unordered_flat_map<std::string, sol::object, transparent_string_hash, std::equal_to<>> methods;
+  sol::protected_function on_spawn;
+  sol::protected_function on_dispose;
+  sol::protected_function on_loop;
+  sol::protected_function on_begin;
+  sol::protected_function on_end;
+  sol::protected_function on_collision;
+  sol::protected_function on_collision_end;
+  sol::protected_function on_hover;
+  sol::protected_function on_unhover;
+  sol::protected_function on_touch;
+  sol::protected_function on_screen_exit;
+  sol::protected_function on_screen_enter;
+  sol::protected_function on_appear;
+  sol::protected_function on_disappear;
+};
+
+struct scriptable {
+  sol::environment parent;
+  std::shared_ptr<const ::prototype> prototype;
   std::shared_ptr<const std::string> bytecode;
   symbol chunkname{};
   functor on_spawn;
   functor on_dispose;
   functor on_loop;
+  bool spawned{false};
 };
 
 class scripting final {
@@ -236,10 +329,15 @@ public:
   explicit scripting(entt::registry& registry) noexcept
       : _registry(registry) {}
 
-  void wire(entt::entity entity, sol::environment& parent, std::shared_ptr<objectproxy> proxy, std::string_view filename);
+  void derive(entt::entity entity, sol::environment& parent, const objectproxy& proxy, std::shared_ptr<const std::string> bytecode, symbol chunkname);
+
+  void spawn(entt::entity entity);
 
-  void derive(entt::entity entity, sol::environment& parent, std::shared_ptr<objectproxy> proxy, std::shared_ptr<const std::string> bytecode, symbol chunkname);
+  void dispose(entt::entity entity);
 
 private:
+  void attach(entt::entity entity, sol::environment& parent, const objectproxy& proxy, std::shared_ptr<const ::prototype> proto, std::shared_ptr<const std::string> bytecode, symbol chunkname);
+
   entt::registry& _registry;
+  boost::unordered_flat_map<symbol, std::shared_ptr<const prototype>> _prototypes;
 };
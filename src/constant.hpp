@@ -13,3 +13,5 @@ static constexpr auto DEGREES_TO_RADIANS = std::numbers::pi_v<float> / 180.0f;
 static constexpr auto RADIANS_TO_DEGREES = 180.0f / std::numbers::pi_v<float>;
 
 static constexpr auto epsilon = std::numeric_limits<float>::epsilon();
+
+static constexpr auto PRELOAD_BUDGET_MS = 4ULL;
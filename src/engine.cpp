@@ -49,6 +49,10 @@ void engine::add_loopable(std::shared_ptr<::loopable> ptr) {
   _loopables.emplace_back(std::move(ptr));
 }
 
+void engine::add_observer(std::shared_ptr<::lifecycleobserver> ptr) {
+  _observers.emplace_back(std::move(ptr));
+}
+
 #ifdef EMSCRIPTEN
 template <class T>
 inline void run(void* userdata) {
@@ -73,6 +77,10 @@ void engine::_loop() {
   const auto delta = std::min(static_cast<float>(static_cast<double>(now - prior) / frequency), MAX_DELTA);
   prior = now;
 
+  for (const auto& observer : _observers) {
+    observer->on_beginupdate();
+  }
+
   if (_tick_interval > .0f) {
     _tick_accumulator += delta;
     while (_tick_accumulator >= _tick_interval) {
@@ -82,10 +90,6 @@ void engine::_loop() {
     }
   }
 
-  for (const auto& observer : _observers) {
-    observer->on_beginupdate();
-  }
-
   _eventmanager->update(delta);
   _scenemanager->update(delta);
   _overlay->update(delta);
@@ -107,12 +111,12 @@ void engine::_loop() {
   _scenemanager->draw();
   _overlay->draw();
 
-  SDL_RenderPresent(renderer);
-
   for (const auto& observer : _observers) {
     observer->on_enddraw();
   }
 
+  SDL_RenderPresent(renderer);
+
 #ifdef HAS_STEAM
   SteamAPI_RunCallbacks();
 #endif
@@ -21,6 +21,8 @@ public:
 
   void add_loopable(std::shared_ptr<::loopable> ptr);
 
+  void add_observer(std::shared_ptr<::lifecycleobserver> ptr);
+
   void run();
 
   void _loop();
@@ -1,9 +1,13 @@
 #include "enginefactory.hpp"
 
+#include "actionmap.hpp"
+#include "assetmanager.hpp"
 #include "engine.hpp"
 #include "eventmanager.hpp"
 #include "fontpool.hpp"
+#include "pixmap.hpp"
 #include "scenemanager.hpp"
+#include "soundfx.hpp"
 #include "textinput.hpp"
 
 enginefactory& enginefactory::with_title(const std::string_view title) {
@@ -82,6 +86,7 @@ enginefactory& enginefactory::with_sentry(const std::string_view dsn) {
   sentry_options_set_database_path(options, ".sentry");
 
   sentry_options_add_attachment(options, "cassette.tape");
+  sentry_options_add_attachment(options, "cassette.journal");
   sentry_options_add_attachment(options, "stdout.txt");
   sentry_options_add_attachment(options, "stderr.txt");
   sentry_options_add_attachment(options, "VERSION");
@@ -99,6 +104,36 @@ enginefactory& enginefactory::with_ticks(const uint8_t ticks) noexcept {
   return *this;
 }
 
+enginefactory& enginefactory::with_cache(const uint32_t megabytes) noexcept {
+  _cache = megabytes;
+  return *this;
+}
+
+enginefactory& enginefactory::with_texturebudget(const uint32_t megabytes) noexcept {
+  _texturebudget = megabytes;
+  return *this;
+}
+
+enginefactory& enginefactory::with_cliplength(const uint32_t milliseconds) noexcept {
+  _cliplength = milliseconds;
+  return *this;
+}
+
+enginefactory& enginefactory::with_polyphony(const uint8_t voices) noexcept {
+  _polyphony = voices;
+  return *this;
+}
+
+enginefactory& enginefactory::with_voicelimit(const uint32_t voices) noexcept {
+  _voicelimit = voices;
+  return *this;
+}
+
+enginefactory& enginefactory::with_actions(const std::string_view filename) {
+  _actions = filename;
+  return *this;
+}
+
 std::shared_ptr<engine> enginefactory::create() const {
   static const auto window = SDL_CreateWindow(
     _title.c_str(),
@@ -129,6 +164,16 @@ std::shared_ptr<engine> enginefactory::create() const {
     static_cast<float>(_height) / _scale
   );
 
+  pixmap::set_budget(static_cast<size_t>(_texturebudget) * 1024uz * 1024uz);
+  soundfx::set_cliplength(_cliplength);
+  soundfx::set_polyphony(_polyphony);
+  soundfx::set_voicelimit(_voicelimit);
+
+  if (!_actions.empty()) {
+    actionmap::load(_actions);
+  }
+
+  const auto assetmanager = std::make_shared<::assetmanager>(static_cast<size_t>(_cache) * 1024uz * 1024uz);
   const auto eventmanager = std::make_shared<::eventmanager>();
   const auto fontpool = std::make_shared<::fontpool>();
   const auto overlay = std::make_shared<::overlay>(eventmanager);
@@ -142,11 +187,17 @@ std::shared_ptr<engine> enginefactory::create() const {
   engine->set_textinput(textinput);
   engine->set_ticks(_ticks);
 
-  eventmanager->add_receiver(engine);
-  eventmanager->add_receiver(overlay);
-  eventmanager->add_receiver(scenemanager);
+  eventmanager->subscribe(engine.get(), {event::kind::quit});
+  eventmanager->subscribe(scenemanager.get(), {
+    event::kind::key_press,
+    event::kind::key_release,
+    event::kind::mouse_press,
+    event::kind::mouse_release,
+    event::kind::mouse_motion
+  });
 
   overlay->set_fontpool(fontpool);
+  scenemanager->set_assetmanager(assetmanager);
   scenemanager->set_fontpool(fontpool);
   scenemanager->set_textinput(textinput);
 
@@ -17,6 +17,12 @@ public:
   enginefactory& with_fullscreen(bool fullscreen) noexcept;
   enginefactory& with_sentry(std::string_view dsn);
   enginefactory& with_ticks(uint8_t ticks) noexcept;
+  enginefactory& with_cache(uint32_t megabytes) noexcept;
+  enginefactory& with_texturebudget(uint32_t megabytes) noexcept;
+  enginefactory& with_cliplength(uint32_t milliseconds) noexcept;
+  enginefactory& with_polyphony(uint8_t voices) noexcept;
+  enginefactory& with_voicelimit(uint32_t voices) noexcept;
+  enginefactory& with_actions(std::string_view filename);
 
   std::shared_ptr<engine> create() const;
 
@@ -28,4 +34,10 @@ private:
   float _gravity{9.8f};
   bool _fullscreen{false};
   uint8_t _ticks{0};
+  uint32_t _cache{64};
+  uint32_t _texturebudget{0};
+  uint32_t _cliplength{3000};
+  uint8_t _polyphony{4};
+  uint32_t _voicelimit{32};
+  std::string _actions;
 };
@@ -3,6 +3,16 @@
 #include "common.hpp"
 
 namespace event {
+enum class kind : uint8_t {
+  quit,
+  key_press,
+  key_release,
+  mouse_press,
+  mouse_release,
+  mouse_motion,
+  count
+};
+
 namespace keyboard {
 enum key : int32_t {
   up = SDLK_UP,
@@ -21,6 +31,8 @@ namespace mouse {
 struct motion {
   float x;
   float y;
+  float dx{0};
+  float dy{0};
 };
 
 struct button {
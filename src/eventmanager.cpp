@@ -1,7 +1,9 @@
 #include "eventmanager.hpp"
 
+#include "actionmap.hpp"
 #include "event.hpp"
 #include "eventreceiver.hpp"
+#include "input.hpp"
 
 eventmanager::eventmanager() {
 }
@@ -9,32 +11,30 @@ eventmanager::eventmanager() {
 void eventmanager::update(float delta) {
   SDL_Event event;
 
-  const auto prune = [&]() {
-    _receivers.erase(
-      std::remove_if(
-        _receivers.begin(),
-        _receivers.end(),
-        [](const auto& receiver) {
-          return receiver.expired();
-        }
-      ),
-      _receivers.end()
-    );
-  };
+  prune();
 
-  const auto dispatch = [&](auto&& call) {
-    auto dirty = false;
-    for (auto it = _receivers.begin(); it != _receivers.end(); ++it) {
-      if (auto receiver = it->lock()) {
+  const auto dispatch = [this](event::kind kind, auto&& call) {
+    const auto& subscribers = _subscribers[static_cast<size_t>(kind)];
+    for (size_t index = 0; index < subscribers.size(); ++index) {
+      if (auto* const receiver = subscribers[index].receiver) [[likely]] {
         call(receiver);
-      } else {
-        dirty = true;
       }
     }
+  };
+
+  std::optional<event::mouse::motion> motion;
 
-    if (dirty) {
-      prune();
+  const auto move = [&]() {
+    if (!motion) {
+      return;
     }
+
+    const auto e = *motion;
+    motion.reset();
+
+    dispatch(event::kind::mouse_motion, [&](auto* receiver) {
+      receiver->on_mouse_motion(e);
+    });
   };
 
   while (SDL_PollEvent(&event)) {
@@ -42,20 +42,26 @@ void eventmanager::update(float delta) {
 
     switch (event.type) {
       case SDL_EVENT_QUIT: {
-        dispatch([](const auto& receiver) {
+        dispatch(event::kind::quit, [](auto* receiver) {
           receiver->on_quit();
         });
       } break;
 
       case SDL_EVENT_KEY_DOWN: {
+        if (!event.key.repeat) {
+          input::record(static_cast<int>(event.key.scancode), true);
+        }
+
         const event::keyboard::key e{static_cast<event::keyboard::key>(event.key.key)};
 
-        dispatch([&](const auto& receiver) {
+        dispatch(event::kind::key_press, [&](auto* receiver) {
           receiver->on_key_press(e);
         });
       } break;
 
       case SDL_EVENT_KEY_UP: {
+        input::record(static_cast<int>(event.key.scancode), false);
+
         switch (event.key.key) {
           case SDLK_F11: {
             auto* const window = SDL_GetRenderWindow(renderer);
@@ -69,20 +75,20 @@ void eventmanager::update(float delta) {
 
         const event::keyboard::key e{static_cast<event::keyboard::key>(event.key.key)};
 
-        dispatch([&](const auto& receiver) {
+        dispatch(event::kind::key_release, [&](auto* receiver) {
           receiver->on_key_release(e);
         });
       } break;
 
       case SDL_EVENT_MOUSE_MOTION: {
-        const event::mouse::motion e{event.motion.x, event.motion.y};
-
-        dispatch([&](const auto& receiver) {
-          receiver->on_mouse_motion(e);
-        });
+        const auto dx = motion ? motion->dx : 0.0f;
+        const auto dy = motion ? motion->dy : 0.0f;
+        motion.emplace(event.motion.x, event.motion.y, dx + event.motion.xrel, dy + event.motion.yrel);
       } break;
 
       case SDL_EVENT_MOUSE_BUTTON_DOWN: {
+        move();
+
         const event::mouse::button e{
           .type = event::mouse::button::type::down,
           .button = static_cast<event::mouse::button::which>(event.button.button),
@@ -90,12 +96,14 @@ void eventmanager::update(float delta) {
           .y = event.button.y
         };
 
-        dispatch([&](const auto& receiver) {
+        dispatch(event::kind::mouse_press, [&](auto* receiver) {
           receiver->on_mouse_press(e);
         });
       } break;
 
       case SDL_EVENT_MOUSE_BUTTON_UP: {
+        move();
+
         const event::mouse::button e{
           .type = event::mouse::button::type::up,
           .button = static_cast<event::mouse::button::which>(event.button.button),
@@ -103,44 +111,74 @@ void eventmanager::update(float delta) {
           .y = event.button.y
         };
 
-        dispatch([&](const auto& receiver) {
+        dispatch(event::kind::mouse_release, [&](auto* receiver) {
           receiver->on_mouse_release(e);
         });
       } break;
 
+      case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+      case SDL_EVENT_GAMEPAD_BUTTON_UP: {
+        input::record(event.gbutton.which, event.gbutton.button, event.gbutton.down);
+      } break;
+
+      case SDL_EVENT_GAMEPAD_ADDED:
+      case SDL_EVENT_GAMEPAD_REMOVED: {
+        input::invalidate();
+      } break;
+
       default:
         break;
     }
   }
+
+  move();
+
+  input::update();
+
+  actionmap::update();
 }
 
-void eventmanager::add_receiver(const std::shared_ptr<eventreceiver>& receiver) {
-  if (!receiver) [[unlikely]] {
-    return;
+eventmanager::subscription eventmanager::subscribe(eventreceiver* receiver, std::initializer_list<event::kind> kinds) {
+  assert(receiver && "receiver must not be null");
+
+  const auto handle = _next++;
+  for (const auto kind : kinds) {
+    _subscribers[static_cast<size_t>(kind)].emplace_back(handle, receiver);
   }
 
-  _receivers.emplace_back(receiver);
+  return handle;
 }
 
-void eventmanager::remove_receiver(const std::shared_ptr<eventreceiver>& receiver) {
-  if (!receiver) [[unlikely]] {
+void eventmanager::unsubscribe(subscription handle) noexcept {
+  for (auto& subscribers : _subscribers) {
+    for (auto& subscriber : subscribers) {
+      if (subscriber.handle == handle) {
+        subscriber.receiver = nullptr;
+        _dirty = true;
+      }
+    }
+  }
+}
+
+void eventmanager::prune() {
+  if (!_dirty) [[likely]] {
     return;
   }
 
-  _receivers.erase(
-    std::remove_if(
-      _receivers.begin(),
-      _receivers.end(),
-      [&](const auto& candidate) {
-        if (auto locked = candidate.lock()) {
-          return locked == receiver;
+  for (auto& subscribers : _subscribers) {
+    subscribers.erase(
+      std::remove_if(
+        subscribers.begin(),
+        subscribers.end(),
+        [](const auto& subscriber) {
+          return subscriber.receiver == nullptr;
         }
+      ),
+      subscribers.end()
+    );
+  }
 
-        return true;
-      }
-    ),
-    _receivers.end()
-  );
+  _dirty = false;
 }
 
 void eventmanager::flush(uint32_t begin_event, uint32_t end_event) {
@@ -2,23 +2,35 @@
 
 #include "common.hpp"
 
+#include "event.hpp"
 #include "noncopyable.hpp"
 
 class eventreceiver;
 
 class eventmanager final : private noncopyable {
 public:
+  using subscription = uint32_t;
+
   eventmanager();
   virtual ~eventmanager() = default;
 
   void update(float delta);
 
-  void add_receiver(const std::shared_ptr<eventreceiver>& receiver);
+  subscription subscribe(eventreceiver* receiver, std::initializer_list<event::kind> kinds);
 
-  void remove_receiver(const std::shared_ptr<eventreceiver>& receiver);
+  void unsubscribe(subscription handle) noexcept;
 
   void flush(uint32_t begin_event, uint32_t end_event = 0);
 
 private:
-  boost::container::small_vector<std::weak_ptr<eventreceiver>, 16> _receivers;
+  struct subscriber final {
+    subscription handle;
+    eventreceiver* receiver;
+  };
+
+  void prune();
+
+  std::array<boost::container::small_vector<subscriber, 4>, static_cast<size_t>(event::kind::count)> _subscribers;
+  subscription _next{1};
+  bool _dirty{false};
 };
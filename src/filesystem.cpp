@@ -1,6 +1,15 @@
 #include "filesystem.hpp"
 
-void filesystem::mount(std::string_view filename, std::string_view mountpoint) noexcept {
+#include "cartridge.hpp"
+#include "io.hpp"
+
+void filesystem::mount(std::string_view filename, std::string_view mountpoint) {
+  if (auto rom = cartridge::open(filename)) {
+    assert(mountpoint == "/" && "packed cartridges are mounted at the root");
+    io::mount(std::move(rom));
+    return;
+  }
+
   [[maybe_unused]] const auto result = PHYSFS_mount(filename.data(), mountpoint.data(), true);
 
   [[maybe_unused]] const auto* const message = PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode());
@@ -4,7 +4,7 @@
 
 class filesystem final {
 public:
-  static void mount(std::string_view filename, std::string_view mountpoint) noexcept;
+  static void mount(std::string_view filename, std::string_view mountpoint);
 
 private:
   filesystem() = delete;
@@ -155,20 +155,24 @@ template<typename T>
 
 struct functor final {
   sol::protected_function fn;
+  sol::object receiver;
   bool active{false};
 
   functor() noexcept = default;
   functor(sol::protected_function f) noexcept : fn(std::move(f)), active(fn.valid() && fn.lua_state() != nullptr) {}
+  functor(sol::protected_function f, sol::object r) noexcept : fn(std::move(f)), receiver(std::move(r)), active(fn.valid() && fn.lua_state() != nullptr) {}
   functor(std::nullptr_t) noexcept {}
 
   functor& operator=(sol::protected_function f) noexcept {
     fn = std::move(f);
+    receiver = sol::object();
     active = fn.valid() && fn.lua_state() != nullptr;
     return *this;
   }
 
   functor& operator=(std::nullptr_t) noexcept {
     fn = sol::protected_function();
+    receiver = sol::object();
     active = false;
     return *this;
   }
@@ -180,7 +184,7 @@ struct functor final {
   template<typename... Args>
   void operator()(Args&&... args) const {
     if (!active) [[unlikely]] return;
-    const auto result = fn(std::forward<Args>(args)...);
+    const auto result = receiver.valid() ? fn(receiver, std::forward<Args>(args)...) : fn(std::forward<Args>(args)...);
     if (!result.valid()) [[unlikely]] {
       const auto error_msg = sol::stack::get<std::string>(result.lua_state(), result.stack_index());
       std::println(stderr, "{}", error_msg);
@@ -191,7 +195,7 @@ struct functor final {
   template<typename R, typename... Args>
   [[nodiscard]] R call(Args&&... args) const {
     if (!active) [[unlikely]] return R{};
-    const auto result = fn(std::forward<Args>(args)...);
+    const auto result = receiver.valid() ? fn(receiver, std::forward<Args>(args)...) : fn(std::forward<Args>(args)...);
     if (!result.valid()) [[unlikely]] {
       throw std::runtime_error(sol::stack::get<std::string>(result.lua_state(), result.stack_index()));
     }
@@ -0,0 +1,207 @@
+#include "input.hpp"
+
+namespace {
+template <size_t N>
+struct edges final {
+  std::bitset<N> pressed;
+  std::bitset<N> released;
+};
+
+std::bitset<SDL_SCANCODE_COUNT> keydown;
+std::bitset<SDL_SCANCODE_COUNT> keypressed;
+std::bitset<SDL_SCANCODE_COUNT> keyreleased;
+edges<SDL_SCANCODE_COUNT> keyedges;
+
+std::array<input::gamepad, input::slots> gamepads;
+std::array<edges<SDL_GAMEPAD_BUTTON_COUNT>, input::slots> padedges;
+std::array<std::unique_ptr<SDL_Gamepad, SDL_Deleter>, input::slots> handles;
+bool stale{true};
+
+const input::names keys{
+  {"a", SDL_SCANCODE_A}, {"b", SDL_SCANCODE_B}, {"c", SDL_SCANCODE_C}, {"d", SDL_SCANCODE_D},
+  {"e", SDL_SCANCODE_E}, {"f", SDL_SCANCODE_F}, {"g", SDL_SCANCODE_G}, {"h", SDL_SCANCODE_H},
+  {"i", SDL_SCANCODE_I}, {"j", SDL_SCANCODE_J}, {"k", SDL_SCANCODE_K}, {"l", SDL_SCANCODE_L},
+  {"m", SDL_SCANCODE_M}, {"n", SDL_SCANCODE_N}, {"o", SDL_SCANCODE_O}, {"p", SDL_SCANCODE_P},
+  {"q", SDL_SCANCODE_Q}, {"r", SDL_SCANCODE_R}, {"s", SDL_SCANCODE_S}, {"t", SDL_SCANCODE_T},
+  {"u", SDL_SCANCODE_U}, {"v", SDL_SCANCODE_V}, {"w", SDL_SCANCODE_W}, {"x", SDL_SCANCODE_X},
+  {"y", SDL_SCANCODE_Y}, {"z", SDL_SCANCODE_Z},
+
+  {"0", SDL_SCANCODE_0}, {"1", SDL_SCANCODE_1}, {"2", SDL_SCANCODE_2}, {"3", SDL_SCANCODE_3},
+  {"4", SDL_SCANCODE_4}, {"5", SDL_SCANCODE_5}, {"6", SDL_SCANCODE_6}, {"7", SDL_SCANCODE_7},
+  {"8", SDL_SCANCODE_8}, {"9", SDL_SCANCODE_9},
+
+  {"up", SDL_SCANCODE_UP}, {"down", SDL_SCANCODE_DOWN},
+  {"left", SDL_SCANCODE_LEFT}, {"right", SDL_SCANCODE_RIGHT},
+
+  {"shift", SDL_SCANCODE_LSHIFT}, {"ctrl", SDL_SCANCODE_LCTRL},
+
+  {"escape", SDL_SCANCODE_ESCAPE}, {"space", SDL_SCANCODE_SPACE},
+  {"enter", SDL_SCANCODE_RETURN}, {"backspace", SDL_SCANCODE_BACKSPACE},
+  {"tab", SDL_SCANCODE_TAB}
+};
+
+const input::names buttons{
+  {"south", SDL_GAMEPAD_BUTTON_SOUTH}, {"east", SDL_GAMEPAD_BUTTON_EAST},
+  {"west", SDL_GAMEPAD_BUTTON_WEST}, {"north", SDL_GAMEPAD_BUTTON_NORTH},
+  {"back", SDL_GAMEPAD_BUTTON_BACK}, {"guide", SDL_GAMEPAD_BUTTON_GUIDE},
+  {"start", SDL_GAMEPAD_BUTTON_START}, {"leftstick", SDL_GAMEPAD_BUTTON_LEFT_STICK},
+  {"rightstick", SDL_GAMEPAD_BUTTON_RIGHT_STICK}, {"leftshoulder", SDL_GAMEPAD_BUTTON_LEFT_SHOULDER},
+  {"rightshoulder", SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER}, {"up", SDL_GAMEPAD_BUTTON_DPAD_UP},
+  {"down", SDL_GAMEPAD_BUTTON_DPAD_DOWN}, {"left", SDL_GAMEPAD_BUTTON_DPAD_LEFT},
+  {"right", SDL_GAMEPAD_BUTTON_DPAD_RIGHT}
+};
+
+const input::names axes{
+  {"leftx", SDL_GAMEPAD_AXIS_LEFTX}, {"lefty", SDL_GAMEPAD_AXIS_LEFTY},
+  {"rightx", SDL_GAMEPAD_AXIS_RIGHTX}, {"righty", SDL_GAMEPAD_AXIS_RIGHTY},
+  {"triggerleft", SDL_GAMEPAD_AXIS_LEFT_TRIGGER}, {"triggerright", SDL_GAMEPAD_AXIS_RIGHT_TRIGGER}
+};
+
+void rescan() {
+  for (auto& handle : handles) {
+    if (handle && !SDL_GamepadConnected(handle.get())) {
+      handle.reset();
+    }
+  }
+
+  auto total = 0;
+  const auto ids = std::unique_ptr<SDL_JoystickID[], SDL_Deleter>(SDL_GetGamepads(&total));
+  const auto count = std::min(static_cast<size_t>(std::max(total, 0)), input::slots);
+  for (auto slot = 0uz; slot < count; ++slot) {
+    if (handles[slot] && SDL_GetGamepadID(handles[slot].get()) == ids[slot]) {
+      continue;
+    }
+
+    handles[slot].reset(SDL_OpenGamepad(ids[slot]));
+  }
+
+  for (auto slot = count; slot < input::slots; ++slot) {
+    handles[slot].reset();
+  }
+
+  for (auto slot = 0uz; slot < input::slots; ++slot) {
+    gamepads[slot].connected = handles[slot] != nullptr;
+    gamepads[slot].name = handles[slot] ? SDL_GetGamepadName(handles[slot].get()) : nullptr;
+  }
+}
+}
+
+void input::update() {
+  if (stale) [[unlikely]] {
+    stale = false;
+    rescan();
+  }
+
+  auto length = 0;
+  const auto* const state = SDL_GetKeyboardState(&length);
+  std::bitset<SDL_SCANCODE_COUNT> current;
+  for (auto scancode = 0uz, limit = std::min(static_cast<size_t>(length), current.size()); scancode < limit; ++scancode) {
+    current[scancode] = state[scancode];
+  }
+
+  keypressed = std::exchange(keyedges.pressed, {});
+  keyreleased = std::exchange(keyedges.released, {});
+  keydown = current;
+
+  for (auto slot = 0uz; slot < slots; ++slot) {
+    auto& pad = gamepads[slot];
+    auto* const handle = handles[slot].get();
+    auto& pending = padedges[slot];
+    if (!handle) {
+      pending = {};
+      pad.pressed.reset();
+      pad.released = pad.down;
+      pad.down.reset();
+      pad.axes.fill(0);
+      continue;
+    }
+
+    std::bitset<SDL_GAMEPAD_BUTTON_COUNT> buttons;
+    for (auto button = 0; button < SDL_GAMEPAD_BUTTON_COUNT; ++button) {
+      buttons[static_cast<size_t>(button)] = SDL_GetGamepadButton(handle, static_cast<SDL_GamepadButton>(button));
+    }
+
+    pad.pressed = std::exchange(pending.pressed, {});
+    pad.released = std::exchange(pending.released, {});
+    pad.down = buttons;
+
+    for (auto axis = 0; axis < SDL_GAMEPAD_AXIS_COUNT; ++axis) {
+      pad.axes[static_cast<size_t>(axis)] = SDL_GetGamepadAxis(handle, static_cast<SDL_GamepadAxis>(axis));
+    }
+  }
+}
+
+void input::record(int scancode, bool down) noexcept {
+  if (scancode < 0 || scancode >= SDL_SCANCODE_COUNT) [[unlikely]] {
+    return;
+  }
+
+  (down ? keyedges.pressed : keyedges.released).set(static_cast<size_t>(scancode));
+}
+
+void input::record(SDL_JoystickID id, int button, bool down) noexcept {
+  if (button < 0 || button >= SDL_GAMEPAD_BUTTON_COUNT) [[unlikely]] {
+    return;
+  }
+
+  for (auto slot = 0uz; slot < slots; ++slot) {
+    if (handles[slot] && SDL_GetGamepadID(handles[slot].get()) == id) {
+      auto& pending = padedges[slot];
+      (down ? pending.pressed : pending.released).set(static_cast<size_t>(button));
+      return;
+    }
+  }
+}
+
+void input::invalidate() noexcept {
+  stale = true;
+}
+
+bool input::down(int scancode) noexcept {
+  return scancode >= 0 && scancode < SDL_SCANCODE_COUNT && keydown[static_cast<size_t>(scancode)];
+}
+
+bool input::pressed(int scancode) noexcept {
+  return scancode >= 0 && scancode < SDL_SCANCODE_COUNT && keypressed[static_cast<size_t>(scancode)];
+}
+
+bool input::released(int scancode) noexcept {
+  return scancode >= 0 && scancode < SDL_SCANCODE_COUNT && keyreleased[static_cast<size_t>(scancode)];
+}
+
+const input::gamepad& input::pad(size_t slot) noexcept {
+  return gamepads[std::min(slot, slots - 1)];
+}
+
+int input::count() noexcept {
+  return static_cast<int>(std::ranges::count_if(gamepads, &gamepad::connected));
+}
+
+int16_t input::deadzone(int16_t value, int16_t limit) noexcept {
+  if (std::abs(value) < limit) {
+    return 0;
+  }
+
+  return value;
+}
+
+float input::deadzone(float value, float limit) noexcept {
+  const auto magnitude = std::abs(value);
+  if (magnitude <= limit || limit >= 1.0f) {
+    return 0.0f;
+  }
+
+  return std::copysign(std::min((magnitude - limit) / (1.0f - limit), 1.0f), value);
+}
+
+const input::names& input::keys() noexcept {
+  return ::keys;
+}
+
+const input::names& input::buttons() noexcept {
+  return ::buttons;
+}
+
+const input::names& input::axes() noexcept {
+  return ::axes;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "common.hpp"
+
+class input final {
+public:
+  static constexpr auto slots = 4uz;
+
+  static constexpr int16_t threshold = 8000;
+
+  using names = boost::unordered_flat_map<std::string_view, int>;
+
+  struct gamepad final {
+    bool connected{false};
+    const char* name{nullptr};
+    std::bitset<SDL_GAMEPAD_BUTTON_COUNT> down;
+    std::bitset<SDL_GAMEPAD_BUTTON_COUNT> pressed;
+    std::bitset<SDL_GAMEPAD_BUTTON_COUNT> released;
+    std::array<int16_t, SDL_GAMEPAD_AXIS_COUNT> axes{};
+  };
+
+  static void update();
+
+  static void record(int scancode, bool down) noexcept;
+
+  static void record(SDL_JoystickID id, int button, bool down) noexcept;
+
+  static void invalidate() noexcept;
+
+  [[nodiscard]] static bool down(int scancode) noexcept;
+  [[nodiscard]] static bool pressed(int scancode) noexcept;
+  [[nodiscard]] static bool released(int scancode) noexcept;
+
+  [[nodiscard]] static const gamepad& pad(size_t slot) noexcept;
+
+  [[nodiscard]] static int count() noexcept;
+
+  [[nodiscard]] static int16_t deadzone(int16_t value, int16_t limit = threshold) noexcept;
+
+  [[nodiscard]] static float deadzone(float value, float limit) noexcept;
+
+  [[nodiscard]] static const names& keys() noexcept;
+  [[nodiscard]] static const names& buttons() noexcept;
+  [[nodiscard]] static const names& axes() noexcept;
+};
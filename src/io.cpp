@@ -1,10 +1,104 @@
 #include "io.hpp"
 
+#include "cartridge.hpp"
+#include "stopwatch.hpp"
+#include "worker.hpp"
+
+namespace {
+std::mutex mutex;
+boost::unordered_flat_map<std::string, std::future<io::buffer>, transparent_string_hash, std::equal_to<>> prefetched;
+
+std::unique_ptr<cartridge> mounted;
+}
+
+void io::mount(std::unique_ptr<::cartridge> cartridge) noexcept {
+  mounted = std::move(cartridge);
+}
+
 bool io::exists(std::string_view filename) noexcept {
+  if (mounted) [[likely]] {
+    return mounted->find(filename) != nullptr;
+  }
+
   return PHYSFS_exists(filename.data());
 }
 
-std::vector<uint8_t> io::read(std::string_view filename) {
+std::span<const uint8_t> io::map(std::string_view filename) noexcept {
+  if (!mounted) [[unlikely]] {
+    return {};
+  }
+
+  const auto* const entry = mounted->find(filename);
+  if (!entry) [[unlikely]] {
+    return {};
+  }
+
+  return mounted->view(*entry);
+}
+
+io::buffer io::read(std::string_view filename) {
+  if (const auto view = map(filename); !view.empty()) {
+    return view;
+  }
+
+  std::future<buffer> future;
+
+  {
+    std::lock_guard lock(mutex);
+    if (const auto it = prefetched.find(filename); it != prefetched.end()) {
+      future = std::move(it->second);
+      prefetched.erase(it);
+    }
+  }
+
+  if (future.valid()) {
+    return future.get();
+  }
+
+  return load(filename);
+}
+
+bool io::prefetch(std::string_view filename) {
+#ifdef EMSCRIPTEN
+  return false;
+#else
+  if (!map(filename).empty()) {
+    return false;
+  }
+
+  std::lock_guard lock(mutex);
+  auto [it, inserted] = prefetched.try_emplace(filename);
+  if (!inserted) {
+    return false;
+  }
+
+  it->second = worker::submit([filename = std::string(filename)] {
+    return load(filename);
+  });
+
+  return true;
+#endif
+}
+
+void io::discard(std::string_view filename) noexcept {
+  std::lock_guard lock(mutex);
+  if (const auto it = prefetched.find(filename); it != prefetched.end()) {
+    prefetched.erase(it);
+  }
+}
+
+io::buffer io::load(std::string_view filename) {
+  stopwatch watch(stage::read, filename);
+
+  if (mounted) [[likely]] {
+    const auto* const entry = mounted->find(filename);
+    if (!entry) [[unlikely]] {
+      throw std::runtime_error(std::format("[cartridge] error while opening file: {}", filename));
+    }
+
+    return mounted->inflate(*entry);
+  }
+
   const auto ptr = unwrap(
     std::unique_ptr<PHYSFS_File, PHYSFS_Deleter>(PHYSFS_openRead(filename.data())),
     std::format("[PHYSFS_openRead] error while opening file: {}", filename)
@@ -32,6 +126,10 @@ std::vector<uint8_t> io::read(std::string_view filename) {
 }
 
 std::vector<std::string> io::enumerate(std::string_view directory) {
+  if (mounted) [[likely]] {
+    return mounted->enumerate(directory);
+  }
+
   std::unique_ptr<char*[], PHYSFS_Deleter> ptr(PHYSFS_enumerateFiles(directory.data()));
   assert(ptr != nullptr &&
     std::format("[PHYSFS_enumerateFiles] error while enumerating directory: {}", directory).c_str());
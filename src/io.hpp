@@ -4,12 +4,54 @@
 
 class io final {
 public:
+  class buffer final {
+  public:
+    buffer() noexcept = default;
+
+    buffer(std::vector<uint8_t>&& storage) noexcept
+        : _storage(std::move(storage)),
+          _view(_storage) {}
+
+    buffer(std::span<const uint8_t> view) noexcept
+        : _view(view) {}
+
+    buffer(buffer&&) noexcept = default;
+    buffer& operator=(buffer&&) noexcept = default;
+
+    buffer(const buffer&) = delete;
+    buffer& operator=(const buffer&) = delete;
+
+    [[nodiscard]] const uint8_t* data() const noexcept { return _view.data(); }
+    [[nodiscard]] size_t size() const noexcept { return _view.size(); }
+    [[nodiscard]] bool empty() const noexcept { return _view.empty(); }
+
+    [[nodiscard]] auto begin() const noexcept { return _view.begin(); }
+    [[nodiscard]] auto end() const noexcept { return _view.end(); }
+
+    operator std::span<const uint8_t>() const noexcept { return _view; }
+
+  private:
+    std::vector<uint8_t> _storage;
+    std::span<const uint8_t> _view;
+  };
+
   io() = delete;
   ~io() = delete;
 
+  static void mount(std::unique_ptr<::cartridge> cartridge) noexcept;
+
   [[nodiscard]] static bool exists(std::string_view filename) noexcept;
 
-  [[nodiscard]] static std::vector<uint8_t> read(std::string_view filename);
+  [[nodiscard]] static buffer read(std::string_view filename);
+
+  [[nodiscard]] static std::span<const uint8_t> map(std::string_view filename) noexcept;
+
+  static bool prefetch(std::string_view filename);
+
+  static void discard(std::string_view filename) noexcept;
 
   [[nodiscard]] static std::vector<std::string> enumerate(std::string_view directory);
-};
\ No newline at end of file
+
+private:
+  [[nodiscard]] static buffer load(std::string_view filename);
+};
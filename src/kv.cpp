@@ -37,6 +37,15 @@ std::shared_ptr<observable> kv::get(std::string_view key, const sol::object& fal
   return it->second;
 }
 
+const observable* kv::find(std::string_view key) const noexcept {
+  const auto it = _values.find(key);
+  if (it == _values.end()) {
+    return nullptr;
+  }
+
+  return it->second.get();
+}
+
 void kv::set(std::string_view key, const sol::object& value) {
   const auto [it, inserted] = _values.try_emplace(key);
 
@@ -20,8 +20,8 @@ private:
 
 class kv final {
 public:
-  ~kv() = default;
   std::shared_ptr<observable> get(std::string_view key, const sol::object& fallback = sol::lua_nil);
+  [[nodiscard]] const observable* find(std::string_view key) const noexcept;
   void set(std::string_view key, const sol::object& value);
 
 private:
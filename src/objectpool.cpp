@@ -1,18 +1,23 @@
 #include "objectpool.hpp"
 
+#include "assetmanager.hpp"
 #include "components.hpp"
 #include "io.hpp"
 #include "objectproxy.hpp"
 #include "pixmap.hpp"
+#include "scriptcache.hpp"
+#include "stopwatch.hpp"
 
 objectpool::objectpool(
     entt::registry& registry,
     physics::world& world,
+    assetmanager& assets,
     std::string_view scenename,
     sol::environment& environment
 )
     : _registry(registry),
       _world(world),
+      _assets(assets),
       _scenename(scenename),
       _environment(environment) {
 }
@@ -20,89 +25,246 @@ objectpool::objectpool(
 void objectpool::add(unmarshal::json node, int32_t z) {
   auto& interning = _registry.ctx().get<::interning>();
 
-  const auto name = node["name"].get<std::string_view>();
+  const auto name = interning.claim(node["name"].get<std::string_view>());
   const auto kind = node["kind"].get<std::string_view>();
   const auto action = interning.intern(node["action"].get<std::string_view>());
   const auto position = node.get<vec2>();
 
+  const auto& blueprint = resolve(kind);
   const auto entity = _registry.create();
+  {
+    stopwatch watch(stage::body, std::format("objects/{}/{}", _scenename, kind));
+    _registry.emplace<physics::body>(entity, physics::body::create(_world, {.type = physics::bodytype::kinematic, .position = position, .entity = entity}));
+  }
 
-  auto [it, inserted] = _shared.try_emplace(kind);
-  if (inserted) {
-    const auto json = unmarshal::parse(io::read(std::format("objects/{}/{}.json", _scenename, kind)));
+  assemble({&entity, 1}, blueprint, {&position, 1}, {&name, 1}, action, z);
+}
 
-    auto atlas = std::make_shared<::atlas>();
-    if (auto timelines = json["timelines"]) {
-      timelines.foreach([&atlas, &interning](std::string_view key, unmarshal::json node) {
-        timeline tl{};
-        tl.oneshot = node["oneshot"].get(false);
+objectproxy objectpool::spawn(std::string_view kind, const vec2& position) {
+  std::vector<objectproxy> out;
+  spawn(kind, std::span{&position, 1}, out);
+  return out.front();
+}
 
-        if (auto nextnode = node["next"]) {
-          tl.next = interning.intern(nextnode.get<std::string_view>());
-        }
+void objectpool::spawn(std::string_view kind, std::span<const vec2> positions, std::vector<objectproxy>& out) {
+  auto& interning = _registry.ctx().get<::interning>();
+  auto& recycler = _registry.ctx().get<::recycler>();
+  const auto& blueprint = resolve(kind);
 
-        if (auto value = node["hitbox"]) {
-          if (auto aabb = value["aabb"]) {
-            tl.hitbox = aabb.get<quad>();
-          }
-        }
+  std::vector<entt::entity> entities(positions.size());
+  auto recycled = 0uz;
+  for (; recycled < entities.size(); ++recycled) {
+    const auto entity = recycler.acquire(blueprint.kind);
+    if (entity == entt::null) {
+      break;
+    }
+
+    entities[recycled] = entity;
+  }
+
+  _registry.create(entities.begin() + static_cast<std::ptrdiff_t>(recycled), entities.end());
+
+  std::vector<symbol> names;
+  names.reserve(entities.size());
+  for (auto i = 0uz; i < entities.size(); ++i) {
+    names.emplace_back(interning.unique(kind, blueprint.kind));
+  }
+
+  assemble(entities, blueprint, positions, names, empty, 0);
+
+  out.reserve(out.size() + entities.size());
+  for (const auto entity : entities) {
+    out.emplace_back(entity, _registry);
+  }
+}
+
+const objectpool::prefab& objectpool::resolve(std::string_view kind) {
+  if (const auto it = _prefabs.find(kind); it != _prefabs.end()) [[likely]] {
+    return it->second;
+  }
+
+  auto& interning = _registry.ctx().get<::interning>();
+
+  const auto filename = std::format("objects/{}/{}.json", _scenename, kind);
+  auto definition = _assets.acquire(filename, [&] {
+    auto definition = std::make_shared<shared>();
+    if (const auto path = baked::sibling(filename, baked::definition_extension); io::exists(path)) {
+      const auto buffer = io::read(path);
+      stopwatch watch(stage::parse, path);
+      unbake(buffer, *definition, interning);
+    } else {
+      const auto buffer = io::read(filename);
+      stopwatch watch(stage::parse, filename);
+      decode(unmarshal::parse(buffer), *definition, interning);
+    }
+
+    const auto cost = sizeof(shared) + definition->atlas->timelines.size() * sizeof(timeline);
+
+    definition->pixmap = _assets.pixmap(std::format("blobs/{}/{}.png", _scenename, kind));
+
+    return std::pair{std::move(definition), cost};
+  });
+
+  for (const auto& value : definition->symbols) {
+    (void)interning.intern(value);
+  }
+
+  prefab result;
+  result.definition = std::move(definition);
+  result.kind = interning.intern(kind);
+
+  const auto script = std::format("objects/{}/{}.lua", _scenename, kind);
+  if (io::exists(script)) {
+    result.chunkname = interning.intern(script);
+    result.bytecode = scriptcache::compile(_environment.lua_state(), script);
+  }
+
+  if (_pinned) {
+    result.definition->pixmap->pin();
+    result.definition->pixmap->restore();
+  }
+
+  return _prefabs.emplace(kind, std::move(result)).first->second;
+}
+
+void objectpool::assemble(std::span<const entt::entity> entities, const prefab& blueprint, std::span<const vec2> positions, std::span<const symbol> names, symbol action, int32_t z) {
+  const auto& definition = *blueprint.definition;
+  const auto tick = SDL_GetTicks();
+
+  const auto put = [this, entities](auto make) {
+    using T = std::invoke_result_t<decltype(make), size_t>;
+    auto& storage = _registry.storage<T>();
+    storage.reserve(storage.size() + entities.size());
+    for (auto i = 0uz; i < entities.size(); ++i) {
+      _registry.emplace_or_replace<T>(entities[i], make(i));
+    }
+  };
+
+  put([&](size_t) { return definition.atlas.get(); });
+  put([&](size_t i) { return transform{.position = positions[i], .angle = .0, .scale = definition.scale}; });
+  put([&](size_t i) { return metadata{.kind = blueprint.kind, .name = names[i]}; });
+  put([](size_t) { return tint{}; });
+  put([&](size_t) { return sprite{.pixmap = definition.pixmap.get()}; });
+  put([&](size_t) { return playback{.current = 0, .tick = tick, .action = action, .timeline = nullptr}; });
+  put([](size_t) { return dirtable{}; });
+  put([](size_t) { return drawable{}; });
+  put([](size_t) { return orientation{}; });
+  put([](size_t) { return velocity{}; });
+  put([z](size_t) { return renderable{.z = z}; });
+
+  for (auto i = 0uz; i < entities.size(); ++i) {
+    const auto entity = entities[i];
+    if (_registry.all_of<dormant>(entity)) {
+      auto& body = _registry.get<physics::body>(entity);
+      body.transform(positions[i], 0.0f);
+      body.enable();
+    } else if (!_registry.all_of<physics::body>(entity)) {
+      _registry.emplace<physics::body>(entity, physics::body::create(_world, {.type = physics::bodytype::kinematic, .position = positions[i], .entity = entity}));
+    }
+  }
 
-        if (auto frames = node["frames"]) {
-          tl.frames.reserve(frames.size());
-          frames.foreach([&tl](unmarshal::json f) {
-            tl.frames.emplace_back(std::move(f));
-          });
+  _registry.ctx().get<renderstate>().z_dirty = true;
+  _registry.remove<dormant>(entities.begin(), entities.end());
+
+  if (blueprint.bytecode) {
+    auto& scripting = _registry.ctx().get<::scripting>();
+    for (const auto entity : entities) {
+      const objectproxy proxy{entity, _registry};
+      scripting.derive(entity, _environment, proxy, blueprint.bytecode, blueprint.chunkname);
+    }
+  }
+}
+
+void objectpool::decode(unmarshal::json json, shared& definition, ::interning& interning) {
+  auto atlas = std::make_shared<::atlas>();
+  if (auto timelines = json["timelines"]) {
+    timelines.foreach([&atlas, &definition, &interning](std::string_view key, unmarshal::json node) {
+      timeline tl{};
+      tl.oneshot = node["oneshot"].get(false);
+
+      if (auto nextnode = node["next"]) {
+        const auto next = nextnode.get<std::string_view>();
+        tl.next = interning.intern(next);
+        definition.symbols.emplace_back(next);
+      }
+
+      if (auto value = node["hitbox"]) {
+        if (auto aabb = value["aabb"]) {
+          tl.hitbox = aabb.get<quad>();
         }
+      }
+
+      if (auto frames = node["frames"]) {
+        tl.frames.reserve(frames.size());
+        frames.foreach([&tl](unmarshal::json f) {
+          tl.frames.emplace_back(std::move(f));
+        });
+      }
 
-        atlas->timelines.try_emplace(interning.intern(key), std::move(tl));
-      });
+      atlas->timelines.try_emplace(interning.intern(key), std::move(tl));
+      definition.symbols.emplace_back(key);
+    });
+  }
+
+  definition.atlas = std::move(atlas);
+  definition.scale = json["scale"].get(1.0f);
+}
+
+void objectpool::unbake(std::span<const uint8_t> data, shared& definition, ::interning& interning) {
+  baked::reader reader(data);
+
+  const auto header = reader.read<baked::object>();
+  if (header.magic != baked::object_magic || header.version != baked::version) [[unlikely]] {
+    throw std::runtime_error("[objectpool] invalid baked object definition");
+  }
+
+  std::vector<baked::timeline> timelines(header.timelines);
+  reader.read(std::span{timelines});
+
+  std::vector<baked::frame> frames(header.frames);
+  reader.read(std::span{frames});
+
+  const auto names = reader.string(header.namesize);
+
+  auto atlas = std::make_shared<::atlas>();
+  atlas->timelines.reserve(timelines.size());
+
+  for (const auto& record : timelines) {
+    if (static_cast<size_t>(record.first) + record.count > frames.size()) [[unlikely]] {
+      throw std::runtime_error("[objectpool] baked timeline frames out of range");
     }
 
-    it->second = shared{
-      .atlas = std::move(atlas),
-      .pixmap = std::make_shared<::pixmap>(std::format("blobs/{}/{}.png", _scenename, kind)),
-      .scale = json["scale"].get(1.0f)
-    };
+    timeline tl{};
+    tl.oneshot = (record.flags & baked::oneshot) != 0;
+
+    if (record.nextlength > 0) {
+      const auto next = names.substr(record.next, record.nextlength);
+      tl.next = interning.intern(next);
+      definition.symbols.emplace_back(next);
+    }
+
+    if (record.flags & baked::hitbox) {
+      tl.hitbox = quad(record.hitbox);
+    }
+
+    const auto first = frames.begin() + static_cast<std::ptrdiff_t>(record.first);
+    tl.frames.assign(first, first + static_cast<std::ptrdiff_t>(record.count));
+
+    const auto key = names.substr(record.name, record.namelength);
+    atlas->timelines.try_emplace(interning.intern(key), std::move(tl));
+    definition.symbols.emplace_back(key);
   }
 
-  _registry.emplace<const ::atlas*>(entity, it->second.atlas.get());
-  _registry.emplace<transform>(entity, transform{
-    .position = position,
-    .angle = .0,
-    .scale = it->second.scale
-  });
-  _registry.emplace<metadata>(entity, metadata{
-    .kind = interning.intern(kind),
-    .name = interning.intern(name)
-  });
-  _registry.emplace<tint>(entity);
-  _registry.emplace<sprite>(entity, sprite{.pixmap = it->second.pixmap.get()});
-  _registry.emplace<playback>(entity, playback{
-    .current = 0,
-    .tick = SDL_GetTicks(),
-    .action = action,
-    .timeline = nullptr
-  });
-  _registry.emplace<dirtable>(entity);
-  _registry.emplace<drawable>(entity);
-  _registry.emplace<orientation>(entity);
-  _registry.emplace<velocity>(entity);
-  _registry.emplace<physics::body>(entity, physics::body::create(_world, {.type = physics::bodytype::kinematic, .position = position, .entity = entity}));
-  _registry.emplace<renderable>(entity, renderable{.z = z});
-
-  const auto proxy = std::make_shared<objectproxy>(entity, _registry);
-  _registry.emplace<std::shared_ptr<objectproxy>>(entity, proxy);
-
-  auto& scripting = _registry.ctx().get<::scripting>();
-  scripting.wire(entity, _environment, proxy, std::format("objects/{}/{}.lua", _scenename, kind));
+  definition.atlas = std::move(atlas);
+  definition.scale = header.scale;
 }
 
 void objectpool::populate(sol::table& pool) const {
   auto& interning = _registry.ctx().get<::interning>();
-  for (auto&& [entity, meta, proxy] : _registry.view<metadata, std::shared_ptr<objectproxy>>().each()) {
+  for (auto&& [entity, meta] : _registry.view<metadata>().each()) {
     const auto name = interning.lookup(meta.name);
     assert(!pool[name].valid() && "duplicate key in pool");
-    pool[name] = proxy;
+    pool[name] = objectproxy{entity, _registry};
   }
 }
 
@@ -112,6 +274,34 @@ void objectpool::sort() {
   }, entt::insertion_sort{});
 }
 
+void objectpool::textures(std::vector<pixmap*>& out) const {
+  for (const auto& [_, blueprint] : _prefabs) {
+    out.emplace_back(blueprint.definition->pixmap.get());
+  }
+}
+
+void objectpool::pin() noexcept {
+  if (_pinned) {
+    return;
+  }
+
+  _pinned = true;
+  for (const auto& [_, blueprint] : _prefabs) {
+    blueprint.definition->pixmap->pin();
+  }
+}
+
+void objectpool::unpin() noexcept {
+  if (!_pinned) {
+    return;
+  }
+
+  _pinned = false;
+  for (const auto& [_, blueprint] : _prefabs) {
+    blueprint.definition->pixmap->unpin();
+  }
+}
+
 void objectpool::draw(entt::entity entity) const noexcept {
   const auto& [pb, tr, tn, sp, fl, dr] = _registry.get<playback, transform, tint, sprite, orientation, drawable>(entity);
 
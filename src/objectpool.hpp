@@ -2,13 +2,18 @@
 
 #include "common.hpp"
 
+#include "components.hpp"
 #include "physics.hpp"
 
+class interning;
+class objectproxy;
+
 class objectpool final {
 public:
   objectpool(
       entt::registry& registry,
       physics::world& world,
+      assetmanager& assets,
       std::string_view scenename,
       sol::environment& environment
   );
@@ -17,23 +22,52 @@ public:
 
   void add(unmarshal::json node, int32_t z);
 
+  [[nodiscard]] objectproxy spawn(std::string_view kind, const vec2& position);
+
+  void spawn(std::string_view kind, std::span<const vec2> positions, std::vector<objectproxy>& out);
+
   void populate(sol::table& pool) const;
 
   void sort();
 
   void draw(entt::entity entity) const noexcept;
 
+  void textures(std::vector<pixmap*>& out) const;
+
+  void pin() noexcept;
+
+  void unpin() noexcept;
+
 private:
   struct shared {
     std::shared_ptr<const atlas> atlas;
     std::shared_ptr<pixmap> pixmap;
     float scale;
+    std::vector<std::string> symbols;
   };
 
+  struct prefab {
+    std::shared_ptr<const shared> definition;
+    symbol kind;
+    symbol chunkname;
+    std::shared_ptr<const std::string> bytecode;
+  };
+
+  const prefab& resolve(std::string_view kind);
+
+  void assemble(std::span<const entt::entity> entities, const prefab& blueprint, std::span<const vec2> positions, std::span<const symbol> names, symbol action, int32_t z);
+
+  static void decode(unmarshal::json json, shared& definition, ::interning& interning);
+
+  static void unbake(std::span<const uint8_t> data, shared& definition, ::interning& interning);
+
   entt::registry& _registry;
   physics::world& _world;
+  assetmanager& _assets;
   boost::static_string<48> _scenename;
   sol::environment& _environment;
 
-  boost::unordered_flat_map<std::string, shared, transparent_string_hash, std::equal_to<>> _shared;
+  boost::unordered_flat_map<std::string, prefab, transparent_string_hash, std::equal_to<>> _prefabs;
+
+  bool _pinned{false};
 };
@@ -2,110 +2,143 @@
 
 #include "components.hpp"
 #include "physics.hpp"
+#include "scheduler.hpp"
 
 objectproxy::objectproxy(entt::entity entity, entt::registry& registry) noexcept
-  : _entity(entity), _registry(registry) {
+  : _entity(entity), _registry(&registry) {
+  _generation = generation();
 }
 
 uint64_t objectproxy::id() const noexcept {
-  return static_cast<uint64_t>(_entity);
+  return static_cast<uint64_t>(_generation) << 32 | static_cast<uint64_t>(entt::to_integral(_entity));
+}
+
+uint32_t objectproxy::generation() const noexcept {
+  if (!_registry->valid(_entity)) [[unlikely]] {
+    return 0;
+  }
+
+  const auto* i = _registry->try_get<incarnation>(_entity);
+  return i ? i->generation : 0;
+}
+
+entt::entity objectproxy::entity() const noexcept {
+  return _entity;
 }
 
 float objectproxy::x() const noexcept {
-  const auto& t = _registry.get<transform>(_entity);
+  const auto& t = _registry->get<transform>(_entity);
   return t.position.x;
 }
 
 void objectproxy::set_x(float x) noexcept {
-  auto [t, d] = _registry.get<transform, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [t, d] = _registry->get<transform, dirtable>(_entity);
   t.position.x = x;
   d.mark(dirtable::render);
 }
 
 float objectproxy::y() const noexcept {
-  const auto& t = _registry.get<transform>(_entity);
+  const auto& t = _registry->get<transform>(_entity);
   return t.position.y;
 }
 
 void objectproxy::set_y(float y) noexcept {
-  auto [t, d] = _registry.get<transform, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [t, d] = _registry->get<transform, dirtable>(_entity);
   t.position.y = y;
   d.mark(dirtable::render);
 }
 
 vec2 objectproxy::position() const noexcept {
-  const auto& t = _registry.get<transform>(_entity);
+  const auto& t = _registry->get<transform>(_entity);
   return t.position;
 }
 
 void objectproxy::set_position(const vec2& position) noexcept {
-  auto [t, d] = _registry.get<transform, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [t, d] = _registry->get<transform, dirtable>(_entity);
   t.position = position;
   d.mark(dirtable::render);
 }
 
 vec2 objectproxy::velocity() const noexcept {
-  const auto& v = _registry.get<::velocity>(_entity);
+  const auto& v = _registry->get<::velocity>(_entity);
   return v.value;
 }
 
 void objectproxy::set_velocity(const vec2& vel) noexcept {
-  auto& v = _registry.get<::velocity>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& v = _registry->get<::velocity>(_entity);
   v.value = vel;
 }
 
 uint8_t objectproxy::alpha() const noexcept {
-  const auto& t = _registry.get<tint>(_entity);
+  const auto& t = _registry->get<tint>(_entity);
   return t.a;
 }
 
 void objectproxy::set_alpha(uint8_t alpha) noexcept {
-  auto [t, d] = _registry.get<tint, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [t, d] = _registry->get<tint, dirtable>(_entity);
   t.a = alpha;
   d.mark(dirtable::physics);
 }
 
 double objectproxy::angle() const noexcept {
-  const auto& t = _registry.get<transform>(_entity);
+  const auto& t = _registry->get<transform>(_entity);
   return t.angle;
 }
 
 void objectproxy::set_angle(double angle) noexcept {
-  auto [t, d] = _registry.get<transform, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [t, d] = _registry->get<transform, dirtable>(_entity);
   t.angle = angle;
   d.mark(dirtable::physics | dirtable::render);
 }
 
 float objectproxy::scale() const noexcept {
-  const auto& t = _registry.get<transform>(_entity);
+  const auto& t = _registry->get<transform>(_entity);
   return t.scale;
 }
 
 void objectproxy::set_scale(float scale) noexcept {
-  auto [t, d] = _registry.get<transform, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [t, d] = _registry->get<transform, dirtable>(_entity);
   t.scale = scale;
   d.mark(dirtable::animation | dirtable::physics | dirtable::render);
 }
 
 bool objectproxy::visible() const noexcept {
-  const auto& r = _registry.get<renderable>(_entity);
+  const auto& r = _registry->get<renderable>(_entity);
   return r.visible;
 }
 
 void objectproxy::set_visible(bool visible) noexcept {
-  auto& r = _registry.get<renderable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& r = _registry->get<renderable>(_entity);
   r.visible = visible;
 }
 
 std::string_view objectproxy::action() const noexcept {
-  const auto& interning = _registry.ctx().get<::interning>();
-  const auto& s = _registry.get<playback>(_entity);
+  const auto& interning = _registry->ctx().get<::interning>();
+  const auto& s = _registry->get<playback>(_entity);
   return interning.lookup(s.action);
 }
 
 void objectproxy::set_action(std::string_view value) {
-  auto& interning = _registry.ctx().get<::interning>();
-  auto [s, at, d] = _registry.get<playback, const atlas*, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& interning = _registry->ctx().get<::interning>();
+  auto [s, at, d] = _registry->get<playback, const atlas*, dirtable>(_entity);
   const auto had = s.timeline != nullptr;
   s.action = interning.intern(value);
   s.current = 0;
@@ -115,181 +148,269 @@ void objectproxy::set_action(std::string_view value) {
   const auto has = s.timeline != nullptr;
   if (had == has) return;
 
-  if (const auto* a = _registry.try_get<appearable>(_entity)) {
+  if (const auto* a = _registry->try_get<appearable>(_entity)) {
     has ? a->on_appear(value) : a->on_disappear();
   }
 }
 
 std::string_view objectproxy::kind() const noexcept {
-  const auto& interning = _registry.ctx().get<::interning>();
-  const auto& m = _registry.get<metadata>(_entity);
+  const auto& interning = _registry->ctx().get<::interning>();
+  const auto& m = _registry->get<metadata>(_entity);
   return interning.lookup(m.kind);
 }
 
 void objectproxy::set_kind(std::string_view value) {
-  auto& interning = _registry.ctx().get<::interning>();
-  auto& m = _registry.get<metadata>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& interning = _registry->ctx().get<::interning>();
+  auto& m = _registry->get<metadata>(_entity);
   m.kind = interning.intern(value);
 }
 
 flip objectproxy::flip() const noexcept {
-  const auto& o = _registry.get<::orientation>(_entity);
+  const auto& o = _registry->get<::orientation>(_entity);
   return o.flip;
 }
 
 void objectproxy::set_flip(::flip flip) noexcept {
-  auto [o, d] = _registry.get<::orientation, dirtable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto [o, d] = _registry->get<::orientation, dirtable>(_entity);
   o.flip = flip;
   d.mark(dirtable::render);
 }
 
 int objectproxy::z() const noexcept {
-  const auto& r = _registry.get<renderable>(_entity);
+  const auto& r = _registry->get<renderable>(_entity);
   return r.z;
 }
 
 void objectproxy::set_z(int value) noexcept {
-  auto& r = _registry.get<renderable>(_entity);
-  auto& state = _registry.ctx().get<renderstate>();
+  if (!alive()) [[unlikely]] return;
+
+  auto& r = _registry->get<renderable>(_entity);
+  auto& state = _registry->ctx().get<renderstate>();
   state.set_z(r, value);
 }
 
 void objectproxy::set_onhover(sol::protected_function fn) {
-  auto& h = _registry.get_or_emplace<hoverable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& h = _registry->get_or_emplace<hoverable>(_entity);
   h.on_hover = std::move(fn);
 }
 
 void objectproxy::set_onunhover(sol::protected_function fn) {
-  auto& h = _registry.get_or_emplace<hoverable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& h = _registry->get_or_emplace<hoverable>(_entity);
   h.on_unhover = std::move(fn);
 }
 
 void objectproxy::set_ontouch(sol::protected_function fn) {
-  auto& t = _registry.get_or_emplace<touchable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& t = _registry->get_or_emplace<touchable>(_entity);
   t.on_touch = std::move(fn);
 }
 
 void objectproxy::set_onbegin(sol::protected_function fn) {
-  auto& a = _registry.get_or_emplace<animatable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& a = _registry->get_or_emplace<animatable>(_entity);
   a.on_begin = std::move(fn);
 }
 
 void objectproxy::set_onend(sol::protected_function fn) {
-  auto& a = _registry.get_or_emplace<animatable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& a = _registry->get_or_emplace<animatable>(_entity);
   a.on_end = std::move(fn);
 }
 
 void objectproxy::set_oncollision(sol::protected_function fn) {
-  auto& c = _registry.get_or_emplace<collidable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& c = _registry->get_or_emplace<collidable>(_entity);
   c.on_collision = std::move(fn);
 }
 
 void objectproxy::set_oncollisionend(sol::protected_function fn) {
-  auto& c = _registry.get_or_emplace<collidable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& c = _registry->get_or_emplace<collidable>(_entity);
   c.on_collision_end = std::move(fn);
 }
 
 void objectproxy::set_ontick(sol::protected_function fn) {
-  auto& t = _registry.get_or_emplace<tickable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& t = _registry->get_or_emplace<tickable>(_entity);
   t.on_tick = std::move(fn);
 }
 
 void objectproxy::set_onscreenexit(sol::protected_function fn) {
-  auto& sb = _registry.get_or_emplace<screenboundable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& sb = _registry->get_or_emplace<screenboundable>(_entity);
   sb.on_screen_exit = std::move(fn);
 }
 
 void objectproxy::set_onscreenenter(sol::protected_function fn) {
-  auto& sb = _registry.get_or_emplace<screenboundable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& sb = _registry->get_or_emplace<screenboundable>(_entity);
   sb.on_screen_enter = std::move(fn);
 }
 
 void objectproxy::set_onappear(sol::protected_function fn) {
-  auto& a = _registry.get_or_emplace<appearable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& a = _registry->get_or_emplace<appearable>(_entity);
   a.on_appear = std::move(fn);
 }
 
 void objectproxy::set_ondisappear(sol::protected_function fn) {
-  auto& a = _registry.get_or_emplace<appearable>(_entity);
+  if (!alive()) [[unlikely]] return;
+
+  auto& a = _registry->get_or_emplace<appearable>(_entity);
   a.on_disappear = std::move(fn);
 }
 
 bool objectproxy::alive() const noexcept {
-  return _registry.valid(_entity);
+  return _registry->valid(_entity) && !_registry->all_of<dormant>(_entity) && generation() == _generation;
 }
 
-void objectproxy::die() noexcept {
+void objectproxy::die() {
   if (!alive()) [[unlikely]] return;
 
-  _registry.destroy(_entity);
+  const auto* m = _registry->try_get<metadata>(_entity);
+  if (!m) [[unlikely]] {
+    _registry->destroy(_entity);
+    return;
+  }
+
+  _registry->emplace<dormant>(_entity);
+  ++_registry->get_or_emplace<incarnation>(_entity).generation;
+
+  if (auto* b = _registry->try_get<physics::body>(_entity)) {
+    b->disable();
+  }
+
+  _registry->ctx().get<scripting>().dispose(_entity);
+
+  if (auto* w = _registry->try_get<awaiter>(_entity)) {
+    const auto tasks = std::move(w->tasks);
+    _registry->remove<awaiter>(_entity);
+    _registry->ctx().get<scheduler>().wake({tasks.data(), tasks.size()});
+  }
+
+  _registry->remove<::kv, tweenable, scriptable, animatable, collidable, hoverable, touchable, screenboundable, appearable, tickable>(_entity);
+  _registry->ctx().get<recycler>().release(m->kind, _entity);
+}
+
+kv& objectproxy::values() {
+  return _registry->get_or_emplace<::kv>(_entity);
+}
+
+const kv* objectproxy::find_values() const noexcept {
+  return _registry->try_get<::kv>(_entity);
 }
 
 std::string_view objectproxy::name() const noexcept {
-  const auto& interning = _registry.ctx().get<::interning>();
-  const auto& m = _registry.get<metadata>(_entity);
+  const auto& interning = _registry->ctx().get<::interning>();
+  const auto& m = _registry->get<metadata>(_entity);
   return interning.lookup(m.name);
 }
 
-std::shared_ptr<objectproxy> objectproxy::clone() {
-  const auto entity = _registry.create();
+void objectproxy::tween(std::span<const tweenable::track> tracks, uint64_t duration, easing curve, sol::protected_function on_complete) {
+  if (!alive()) [[unlikely]] return;
 
-  auto [m, tn, sp, pb, tf, at, ori, rn, sc] = _registry.try_get<metadata, tint, sprite, playback, transform, const atlas*, orientation, renderable, scriptable>(_entity);
+  auto& tw = _registry->get_or_emplace<tweenable>(_entity);
+  auto& step = tw.steps.emplace_back();
+  step.tracks.assign(tracks.begin(), tracks.end());
+  step.duration = duration;
+  step.curve = curve;
+  step.on_complete = std::move(on_complete);
+}
+
+void objectproxy::untween() noexcept {
+  if (!alive()) [[unlikely]] return;
+
+  _registry->remove<tweenable>(_entity);
+}
+
+objectproxy objectproxy::clone() {
+  auto [m, tn, sp, pb, tf, at, ori, rn, sc] = _registry->try_get<metadata, tint, sprite, playback, transform, const atlas*, orientation, renderable, scriptable>(_entity);
+
+  const auto recycled = m ? _registry->ctx().get<recycler>().acquire(m->kind) : entt::entity{entt::null};
+  const auto entity = recycled != entt::null ? recycled : _registry->create();
 
   if (m) {
-    auto& interning = _registry.ctx().get<::interning>();
+    auto& interning = _registry->ctx().get<::interning>();
     metadata cp = *m;
     const auto original = interning.lookup(m->name);
-    cp.name = interning.intern(std::format("{}_{}", original, interning.increment(m->name)));
+    cp.name = interning.unique(original, m->name);
 
-    _registry.emplace<metadata>(entity, cp);
+    _registry->emplace_or_replace<metadata>(entity, cp);
   }
 
   if (tn) {
-    _registry.emplace<tint>(entity, *tn);
+    _registry->emplace_or_replace<tint>(entity, *tn);
   }
 
   if (sp) {
-    _registry.emplace<sprite>(entity, *sp);
+    _registry->emplace_or_replace<sprite>(entity, *sp);
   }
 
   if (pb) {
-    _registry.emplace<playback>(entity, *pb);
+    _registry->emplace_or_replace<playback>(entity, *pb);
   }
 
   if (tf) {
-    _registry.emplace<transform>(entity, *tf);
+    _registry->emplace_or_replace<transform>(entity, *tf);
   }
 
   if (at) {
-    _registry.emplace<const atlas*>(entity, *at);
+    _registry->emplace_or_replace<const atlas*>(entity, *at);
   }
 
   if (ori) {
-    _registry.emplace<orientation>(entity, *ori);
+    _registry->emplace_or_replace<orientation>(entity, *ori);
   }
 
-  _registry.emplace<dirtable>(entity);
-  _registry.emplace<drawable>(entity);
+  _registry->emplace_or_replace<dirtable>(entity);
+  _registry->emplace_or_replace<drawable>(entity);
+  _registry->emplace_or_replace<struct velocity>(entity);
 
   const auto position = tf ? tf->position : vec2{0, 0};
-  auto* world = _registry.ctx().get<physics::world*>();
-  _registry.emplace<physics::body>(entity, physics::body::create(*world, {.type = physics::bodytype::kinematic, .position = position, .entity = entity}));
-  _registry.emplace<struct velocity>(entity);
+  if (recycled != entt::null) {
+    auto& body = _registry->get<physics::body>(entity);
+    body.transform(position, 0.0f);
+    body.enable();
+  } else {
+    auto* world = _registry->ctx().get<physics::world*>();
+    _registry->emplace<physics::body>(entity, physics::body::create(*world, {.type = physics::bodytype::kinematic, .position = position, .entity = entity}));
+  }
 
   if (rn) {
     renderable copy = *rn;
     copy.z = rn->z + 1;
-    _registry.emplace<renderable>(entity, std::move(copy));
-    _registry.ctx().get<renderstate>().z_dirty = true;
+    _registry->emplace_or_replace<renderable>(entity, std::move(copy));
+    _registry->ctx().get<renderstate>().z_dirty = true;
   }
 
-  auto proxy = std::make_shared<objectproxy>(entity, _registry);
-  _registry.emplace<std::shared_ptr<objectproxy>>(entity, proxy);
+  _registry->remove<dormant>(entity);
 
-  if (sc && sc->bytecode) {
-    auto& scripting = _registry.ctx().get<::scripting>();
-    scripting.derive(entity, sc->parent, proxy, sc->bytecode, sc->chunkname);
+  const objectproxy proxy{entity, *_registry};
+
+  if (sc) {
+    auto parent = sc->parent;
+    auto& scripting = _registry->ctx().get<::scripting>();
+    scripting.derive(entity, parent, proxy, sc->bytecode, sc->chunkname);
   }
 
+  _registry->ctx().get<scripting>().spawn(entity);
+
   return proxy;
 }
@@ -8,14 +8,16 @@
 
 struct metaobject;
 
-class objectproxy {
+class objectproxy final {
   friend struct metaobject;
 
 public:
   objectproxy(entt::entity entity, entt::registry& registry) noexcept;
-  ~objectproxy() noexcept = default;
+
+  [[nodiscard]] bool operator==(const objectproxy& other) const noexcept = default;
 
   [[nodiscard]] uint64_t id() const noexcept;
+  [[nodiscard]] entt::entity entity() const noexcept;
 
   [[nodiscard]] float x() const noexcept;
   void set_x(float x) noexcept;
@@ -64,14 +66,23 @@ public:
   void set_onappear(sol::protected_function fn);
   void set_ondisappear(sol::protected_function fn);
 
-  [[nodiscard]] std::shared_ptr<objectproxy> clone();
+  void tween(std::span<const tweenable::track> tracks, uint64_t duration, easing curve, sol::protected_function on_complete);
+  void untween() noexcept;
+
+  [[nodiscard]] objectproxy clone();
 
   [[nodiscard]] bool alive() const noexcept;
-  void die() noexcept;
+  void die();
 
-  kv kv;
+  [[nodiscard]] ::kv& values();
+  [[nodiscard]] const ::kv* find_values() const noexcept;
 
 private:
+  [[nodiscard]] uint32_t generation() const noexcept;
+
   entt::entity _entity;
-  entt::registry& _registry;
+  entt::registry* _registry;
+  uint32_t _generation{0};
 };
+
+static_assert(std::is_trivially_copyable_v<objectproxy>);
@@ -8,6 +8,10 @@
 overlay::overlay(std::shared_ptr<eventmanager> eventmanager)
     : _eventmanager(std::move(eventmanager)) {}
 
+overlay::~overlay() noexcept {
+  cursor(nullptr);
+}
+
 void overlay::set_fontpool(std::shared_ptr<::fontpool> fontpool) noexcept {
   _fontpool = std::move(fontpool);
 }
@@ -16,7 +20,7 @@ void overlay::cursor(std::string_view resource) {
   cursor(nullptr);
 
   _cursor = std::make_shared<::cursor>(resource);
-  _eventmanager->add_receiver(_cursor);
+  _subscription = _eventmanager->subscribe(_cursor.get(), {event::kind::mouse_release, event::kind::mouse_motion});
 }
 
 void overlay::cursor(std::nullptr_t) {
@@ -24,7 +28,7 @@ void overlay::cursor(std::nullptr_t) {
     return;
   }
 
-  _eventmanager->remove_receiver(_cursor);
+  _eventmanager->unsubscribe(_subscription);
   _cursor.reset();
 }
 
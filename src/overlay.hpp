@@ -2,12 +2,13 @@
 
 #include "common.hpp"
 
+#include "eventmanager.hpp"
 #include "widget.hpp"
 
-class overlay final : public eventreceiver {
+class overlay final {
 public:
   explicit overlay(std::shared_ptr<eventmanager> eventmanager);
-  virtual ~overlay() noexcept = default;
+  ~overlay() noexcept;
 
   void set_fontpool(std::shared_ptr<::fontpool> fontpool) noexcept;
 
@@ -28,5 +29,6 @@ private:
   std::shared_ptr<::cursor> _cursor;
   std::shared_ptr<fontpool> _fontpool;
   std::shared_ptr<eventmanager> _eventmanager;
+  eventmanager::subscription _subscription{0};
   boost::container::small_vector<std::shared_ptr<widget>, 16> _labels;
 };
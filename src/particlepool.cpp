@@ -1,8 +1,10 @@
 #include "particlepool.hpp"
 
+#include "assetmanager.hpp"
 #include "components.hpp"
 #include "io.hpp"
 #include "pixmap.hpp"
+#include "stopwatch.hpp"
 
 namespace {
 
@@ -44,10 +46,78 @@ static void range(unmarshal::json node, std::pair<T, T>& out) noexcept {
 
   out = {node["start"].get(out.first), node["end"].get(out.second)};
 }
+
+static void decode(unmarshal::json json, cache& definition) {
+  definition.count = json["count"].get<size_t>();
+  definition.xspawn = {.0f, .0f};
+  definition.yspawn = {.0f, .0f};
+  definition.radius = {.0f, .0f};
+  definition.angle = {.0f, .0f};
+  definition.scale = {1.0f, 1.0f};
+  definition.life = {1.0f, 1.0f};
+  definition.xvel = {.0f, .0f};
+  definition.yvel = {.0f, .0f};
+  definition.gx = {.0f, .0f};
+  definition.gy = {.0f, .0f};
+  definition.rforce = {.0f, .0f};
+  definition.rvel = {.0f, .0f};
+
+  if (auto spawn = json["spawn"]) {
+    range(spawn["x"], definition.xspawn);
+    range(spawn["y"], definition.yspawn);
+    range(spawn["radius"], definition.radius);
+    range(spawn["angle"], definition.angle);
+    range(spawn["scale"], definition.scale);
+    range(spawn["life"], definition.life);
+  }
+
+  if (auto velocity = json["velocity"]) {
+    range(velocity["x"], definition.xvel);
+    range(velocity["y"], definition.yvel);
+  }
+
+  if (auto gravity = json["gravity"]) {
+    range(gravity["x"], definition.gx);
+    range(gravity["y"], definition.gy);
+  }
+
+  if (auto rotation = json["rotation"]) {
+    range(rotation["force"], definition.rforce);
+    range(rotation["velocity"], definition.rvel);
+  }
+}
+
+static void unbake(std::span<const uint8_t> data, cache& definition) {
+  baked::reader reader(data);
+
+  const auto header = reader.read<baked::particle>();
+  if (header.magic != baked::particle_magic || header.version != baked::version) [[unlikely]] {
+    throw std::runtime_error("[particlepool] invalid baked particle definition");
+  }
+
+  const auto pair = [](const std::array<float, 2>& value) {
+    return std::pair{value[0], value[1]};
+  };
+
+  definition.count = header.count;
+  definition.xspawn = pair(header.xspawn);
+  definition.yspawn = pair(header.yspawn);
+  definition.radius = pair(header.radius);
+  definition.angle = pair(header.angle);
+  definition.scale = pair(header.scale);
+  definition.life = pair(header.life);
+  definition.xvel = pair(header.xvel);
+  definition.yvel = pair(header.yvel);
+  definition.gx = pair(header.gx);
+  definition.gy = pair(header.gy);
+  definition.rforce = pair(header.rforce);
+  definition.rvel = pair(header.rvel);
+}
 }
 
-particlepool::particlepool(entt::registry& registry)
-    : _registry(registry) {
+particlepool::particlepool(entt::registry& registry, assetmanager& assets)
+    : _registry(registry),
+      _assets(assets) {
   _batches.reserve(16);
 }
 
@@ -70,72 +140,50 @@ void particlepool::add(unmarshal::json node, int32_t z) {
   {
     auto [it, inserted] = _cache.try_emplace(kind);
     if (inserted) {
-      auto json = unmarshal::parse(io::read(std::format("particles/{}.json", kind)));
-
-      it->second.count = json["count"].get<size_t>();
-      it->second.xspawn = {.0f, .0f};
-      it->second.yspawn = {.0f, .0f};
-      it->second.radius = {.0f, .0f};
-      it->second.angle = {.0f, .0f};
-      it->second.scale = {1.0f, 1.0f};
-      it->second.life = {1.0f, 1.0f};
-      it->second.xvel = {.0f, .0f};
-      it->second.yvel = {.0f, .0f};
-      it->second.gx = {.0f, .0f};
-      it->second.gy = {.0f, .0f};
-      it->second.rforce = {.0f, .0f};
-      it->second.rvel = {.0f, .0f};
-
-      if (auto spawn = json["spawn"]) {
-        range(spawn["x"], it->second.xspawn);
-        range(spawn["y"], it->second.yspawn);
-        range(spawn["radius"], it->second.radius);
-        range(spawn["angle"], it->second.angle);
-        range(spawn["scale"], it->second.scale);
-        range(spawn["life"], it->second.life);
-      }
-
-      if (auto velocity = json["velocity"]) {
-        range(velocity["x"], it->second.xvel);
-        range(velocity["y"], it->second.yvel);
-      }
-
-      if (auto gravity = json["gravity"]) {
-        range(gravity["x"], it->second.gx);
-        range(gravity["y"], it->second.gy);
-      }
-
-      if (auto rotation = json["rotation"]) {
-        range(rotation["force"], it->second.rforce);
-        range(rotation["velocity"], it->second.rvel);
-      }
-
-      it->second.pixmap = std::make_shared<::pixmap>(std::format("blobs/particles/{}.png", kind));
+      const auto filename = std::format("particles/{}.json", kind);
+      it->second = _assets.acquire(filename, [&] {
+        auto definition = std::make_shared<cache>();
+        if (const auto path = baked::sibling(filename, baked::definition_extension); io::exists(path)) {
+          const auto buffer = io::read(path);
+          stopwatch watch(stage::parse, path);
+          unbake(buffer, *definition);
+        } else {
+          const auto buffer = io::read(filename);
+          stopwatch watch(stage::parse, filename);
+          decode(unmarshal::parse(buffer), *definition);
+        }
+
+        definition->pixmap = _assets.pixmap(std::format("blobs/particles/{}.png", kind));
+
+        return std::pair{std::move(definition), sizeof(cache)};
+      });
     }
 
+    const auto& definition = *it->second;
+
     const auto props = std::make_shared<particleprops>();
     props->spawning = spawning;
     props->x = x;
     props->y = y;
-    props->hw = static_cast<float>(it->second.pixmap->width()) * .5f;
-    props->hh = static_cast<float>(it->second.pixmap->height()) * .5f;
-    props->xspawnd = rng::uniform_real<float>(it->second.xspawn.first, it->second.xspawn.second);
-    props->yspawnd = rng::uniform_real<float>(it->second.yspawn.first, it->second.yspawn.second);
-    props->radiusd = rng::uniform_real<float>(it->second.radius.first, it->second.radius.second);
-    props->angled = rng::uniform_real<float>(it->second.angle.first, it->second.angle.second);
-    props->xveld = rng::uniform_real<float>(it->second.xvel.first, it->second.xvel.second);
-    props->yveld = rng::uniform_real<float>(it->second.yvel.first, it->second.yvel.second);
-    props->gxd = rng::uniform_real<float>(it->second.gx.first, it->second.gx.second);
-    props->gyd = rng::uniform_real<float>(it->second.gy.first, it->second.gy.second);
-    props->lifed = rng::uniform_real<float>(it->second.life.first, it->second.life.second);
-    props->scaled = rng::uniform_real<float>(it->second.scale.first, it->second.scale.second);
-    props->rotforced = rng::uniform_real<float>(it->second.rforce.first, it->second.rforce.second);
-    props->rotveld = rng::uniform_real<float>(it->second.rvel.first, it->second.rvel.second);
-
-    const auto count = it->second.count;
+    props->hw = static_cast<float>(definition.pixmap->width()) * .5f;
+    props->hh = static_cast<float>(definition.pixmap->height()) * .5f;
+    props->xspawnd = rng::uniform_real<float>(definition.xspawn.first, definition.xspawn.second);
+    props->yspawnd = rng::uniform_real<float>(definition.yspawn.first, definition.yspawn.second);
+    props->radiusd = rng::uniform_real<float>(definition.radius.first, definition.radius.second);
+    props->angled = rng::uniform_real<float>(definition.angle.first, definition.angle.second);
+    props->xveld = rng::uniform_real<float>(definition.xvel.first, definition.xvel.second);
+    props->yveld = rng::uniform_real<float>(definition.yvel.first, definition.yvel.second);
+    props->gxd = rng::uniform_real<float>(definition.gx.first, definition.gx.second);
+    props->gyd = rng::uniform_real<float>(definition.gy.first, definition.gy.second);
+    props->lifed = rng::uniform_real<float>(definition.life.first, definition.life.second);
+    props->scaled = rng::uniform_real<float>(definition.scale.first, definition.scale.second);
+    props->rotforced = rng::uniform_real<float>(definition.rforce.first, definition.rforce.second);
+    props->rotveld = rng::uniform_real<float>(definition.rvel.first, definition.rvel.second);
+
+    const auto count = definition.count;
     batch = std::make_shared<particlebatch>();
     batch->props = std::move(props);
-    batch->pixmap = it->second.pixmap;
+    batch->pixmap = definition.pixmap;
     batch->particles.resize(count);
     batch->vertices.resize(count * 4);
     batch->indices.resize(count * 6);
@@ -178,11 +226,21 @@ void particlepool::clear() {
   _batches.clear();
 }
 
+void particlepool::textures(std::vector<pixmap*>& out) const {
+  for (const auto& [_, definition] : _cache) {
+    out.emplace_back(definition->pixmap.get());
+  }
+}
+
 void particlepool::draw(entt::entity entity) const noexcept {
   const auto& pr = _registry.get<particlerenderable>(entity);
+  auto* const texture = static_cast<SDL_Texture*>(*pr.batch->pixmap);
+  if (!texture) [[unlikely]] {
+    return;
+  }
 
   SDL_RenderGeometry(renderer,
-    static_cast<SDL_Texture*>(*pr.batch->pixmap),
+    texture,
     pr.batch->vertices.data(),
     static_cast<int>(pr.batch->vertices.size()),
     pr.batch->indices.data(),
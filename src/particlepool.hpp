@@ -76,7 +76,7 @@ struct particlebatch final {
 
 class particlepool final {
 public:
-  particlepool(entt::registry& registry);
+  particlepool(entt::registry& registry, assetmanager& assets);
   ~particlepool() = default;
 
   void add(unmarshal::json node, int32_t z);
@@ -89,8 +89,11 @@ public:
 
   void draw(entt::entity entity) const noexcept;
 
+  void textures(std::vector<pixmap*>& out) const;
+
 private:
   entt::registry& _registry;
-  mutable boost::unordered_flat_map<std::string, cache, transparent_string_hash, std::equal_to<>> _cache;
+  assetmanager& _assets;
+  boost::unordered_flat_map<std::string, std::shared_ptr<const cache>, transparent_string_hash, std::equal_to<>> _cache;
   boost::unordered_flat_map<std::string, std::pair<entt::entity, std::shared_ptr<particlebatch>>, transparent_string_hash, std::equal_to<>> _batches;
 };
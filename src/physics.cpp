@@ -104,6 +104,14 @@ void body::transform(const vec2& position, float angle) noexcept {
   b2Body_SetTransform(id, to_b2(position), b2MakeRot(angle));
 }
 
+void body::enable() noexcept {
+  b2Body_Enable(id);
+}
+
+void body::disable() noexcept {
+  b2Body_Disable(id);
+}
+
 bool body::has_shape() const noexcept {
   return b2Shape_IsValid(shape);
 }
@@ -139,6 +139,8 @@ struct body final {
   void attach_sensor(float hx, float hy) noexcept;
   void detach() noexcept;
   void transform(const vec2& position, float angle) noexcept;
+  void enable() noexcept;
+  void disable() noexcept;
   [[nodiscard]] bool has_shape() const noexcept;
 };
 
@@ -1,7 +1,118 @@
 #include "pixmap.hpp"
 
-pixmap::pixmap(std::string_view filename) {
+#include "baked.hpp"
+#include "io.hpp"
+#include "stopwatch.hpp"
+#include "worker.hpp"
+
+namespace {
+std::mutex mutex;
+boost::unordered_flat_map<std::string, std::future<pixmap::image>, transparent_string_hash, std::equal_to<>> prefetched;
+
+size_t allocated{0};
+size_t ceiling{0};
+uint64_t frame{0};
+}
+
+pixmap::pixmap(std::string_view filename)
+    : _filename(filename) {
+  const auto decoded = fetch(filename);
+
+  _width = decoded.width;
+  _height = decoded.height;
+  _drawn = frame;
+
+  upload(decoded);
+}
+
+pixmap::~pixmap() noexcept {
+  release();
+}
+
+void pixmap::upload(const image& decoded) const {
+  stopwatch watch(stage::upload, _filename);
+
+  _texture = std::unique_ptr<SDL_Texture, SDL_Deleter>(
+      SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, _width, _height));
+
+  SDL_UpdateTexture(_texture.get(), nullptr, decoded.pixels.get(), _width * SDL_BYTESPERPIXEL(SDL_PIXELFORMAT_RGBA32));
+  SDL_SetTextureScaleMode(_texture.get(), SDL_SCALEMODE_NEAREST);
+  SDL_SetTextureBlendMode(_texture.get(), decoded.premultiplied ? SDL_BLENDMODE_BLEND_PREMULTIPLIED : SDL_BLENDMODE_BLEND);
+
+  allocated += bytes();
+}
+
+void pixmap::restore() const noexcept {
+  _drawn = frame;
+
+  if (_texture) [[likely]] {
+    return;
+  }
+
+  try {
+    std::future<image> future;
+
+    {
+      std::lock_guard lock(mutex);
+      if (const auto it = prefetched.find(_filename); it != prefetched.end()) {
+        if (it->second.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+          return;
+        }
+
+        future = std::move(it->second);
+        prefetched.erase(it);
+      }
+    }
+
+    if (future.valid()) {
+      upload(future.get());
+      return;
+    }
+
+    if (prefetch(_filename)) {
+      return;
+    }
+
+    upload(decode(_filename));
+  } catch (const std::exception& e) {
+    std::println(stderr, "[pixmap] failed to restore {}: {}", _filename, e.what());
+  }
+}
+
+void pixmap::release() noexcept {
+  if (!_texture) {
+    return;
+  }
+
+  _texture.reset();
+  allocated -= bytes();
+}
+
+pixmap::image pixmap::fetch(std::string_view filename) {
+  std::future<image> future;
+
+  {
+    std::lock_guard lock(mutex);
+    if (const auto it = prefetched.find(filename); it != prefetched.end()) {
+      future = std::move(it->second);
+      prefetched.erase(it);
+    }
+  }
+
+  return future.valid() ? future.get() : decode(filename);
+}
+
+pixmap::image pixmap::decode(std::string_view filename) {
+  if (filename.ends_with(".png")) {
+    auto path = std::string(filename.substr(0, filename.size() - 4));
+    path += baked::texture_extension;
+    if (io::exists(path)) {
+      return unbake(path);
+    }
+  }
+
   const auto buffer = io::read(filename);
+  stopwatch watch(stage::decode, filename);
 
   auto spng =
     std::unique_ptr<spng_ctx, SPNG_Deleter>(spng_ctx_new(SPNG_CTX_IGNORE_ADLER32));
@@ -12,21 +123,91 @@ pixmap::pixmap(std::string_view filename) {
   spng_ihdr ihdr;
   spng_get_ihdr(spng.get(), &ihdr);
 
-  _width = static_cast<int>(ihdr.width);
-  _height = static_cast<int>(ihdr.height);
-
   size_t length;
   spng_decoded_image_size(spng.get(), SPNG_FMT_RGBA8, &length);
 
-  auto pixels = std::make_unique_for_overwrite<uint8_t[]>(length);
-  spng_decode_image(spng.get(), pixels.get(), length, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS);
+  image result{
+    .width = static_cast<int>(ihdr.width),
+    .height = static_cast<int>(ihdr.height),
+    .pixels = std::make_unique_for_overwrite<uint8_t[]>(length)
+  };
 
-  _texture = std::unique_ptr<SDL_Texture, SDL_Deleter>(
-      SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, _width, _height));
+  spng_decode_image(spng.get(), result.pixels.get(), length, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS);
 
-  SDL_UpdateTexture(_texture.get(), nullptr, pixels.get(), _width * SDL_BYTESPERPIXEL(SDL_PIXELFORMAT_RGBA32));
-  SDL_SetTextureScaleMode(_texture.get(), SDL_SCALEMODE_NEAREST);
-  SDL_SetTextureBlendMode(_texture.get(), SDL_BLENDMODE_BLEND);
+  return result;
+}
+
+pixmap::image pixmap::unbake(std::string_view filename) {
+  const auto buffer = io::read(filename);
+  stopwatch watch(stage::decode, filename);
+
+  baked::texture header;
+  if (buffer.size() < sizeof(header)) [[unlikely]] {
+    throw std::runtime_error(std::format("[pixmap] truncated texture: {}", filename));
+  }
+
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  if (header.magic != baked::texture_magic || header.version != baked::version) [[unlikely]] {
+    throw std::runtime_error(std::format("[pixmap] invalid texture: {}", filename));
+  }
+
+  const auto length = static_cast<size_t>(header.width) * static_cast<size_t>(header.height) * 4uz;
+  const auto* const payload = buffer.data() + sizeof(header);
+  if (buffer.size() - sizeof(header) < header.size) [[unlikely]] {
+    throw std::runtime_error(std::format("[pixmap] truncated texture: {}", filename));
+  }
+
+  image result{
+    .width = static_cast<int>(header.width),
+    .height = static_cast<int>(header.height),
+    .premultiplied = (header.flags & baked::premultiplied) != 0,
+    .pixels = std::make_unique_for_overwrite<uint8_t[]>(length)
+  };
+
+  if (header.flags & baked::lz4) {
+    const auto written = LZ4_decompress_safe(
+      reinterpret_cast<const char*>(payload),
+      reinterpret_cast<char*>(result.pixels.get()),
+      static_cast<int>(header.size),
+      static_cast<int>(length));
+
+    if (written != static_cast<int>(length)) [[unlikely]] {
+      throw std::runtime_error(std::format("[LZ4_decompress_safe] corrupted texture: {}", filename));
+    }
+  } else {
+    if (header.size != length) [[unlikely]] {
+      throw std::runtime_error(std::format("[pixmap] invalid texture size: {}", filename));
+    }
+
+    std::memcpy(result.pixels.get(), payload, length);
+  }
+
+  return result;
+}
+
+bool pixmap::prefetch(std::string_view filename) {
+#ifdef EMSCRIPTEN
+  return false;
+#else
+  std::lock_guard lock(mutex);
+  auto [it, inserted] = prefetched.try_emplace(filename);
+  if (!inserted) {
+    return false;
+  }
+
+  it->second = worker::submit([filename = std::string(filename)] {
+    return decode(filename);
+  });
+
+  return true;
+#endif
+}
+
+void pixmap::discard(std::string_view filename) noexcept {
+  std::lock_guard lock(mutex);
+  if (const auto it = prefetched.find(filename); it != prefetched.end()) {
+    prefetched.erase(it);
+  }
 }
 
 void pixmap::draw(
@@ -36,6 +217,12 @@ void pixmap::draw(
     const uint8_t alpha,
     const flip flip
 ) const noexcept {
+  restore();
+
+  if (!_texture) [[unlikely]] {
+    return;
+  }
+
   const SDL_FRect source{ sx, sy, sw, sh };
   const SDL_FRect destination{ dx, dy, dw, dh };
 
@@ -44,6 +231,7 @@ void pixmap::draw(
 }
 
 pixmap::operator SDL_Texture*() const noexcept {
+  restore();
   return _texture.get();
 }
 
@@ -54,3 +242,80 @@ int pixmap::width() const noexcept {
 int pixmap::height() const noexcept {
   return _height;
 }
+
+size_t pixmap::bytes() const noexcept {
+  return static_cast<size_t>(_width) * static_cast<size_t>(_height) * SDL_BYTESPERPIXEL(SDL_PIXELFORMAT_RGBA32);
+}
+
+bool pixmap::resident() const noexcept {
+  return _texture != nullptr;
+}
+
+void pixmap::pin() noexcept {
+  ++_pins;
+}
+
+void pixmap::unpin() noexcept {
+  assert(_pins > 0 && "unbalanced pixmap unpin");
+  --_pins;
+}
+
+size_t pixmap::usage() noexcept {
+  return allocated;
+}
+
+void pixmap::set_budget(size_t bytes) noexcept {
+  ceiling = bytes;
+}
+
+void pixmap::advance() noexcept {
+  ++frame;
+}
+
+bool pixmap::exceeded() noexcept {
+  return ceiling != 0 && allocated > ceiling;
+}
+
+void pixmap::collect(std::vector<pixmap*>& candidates) noexcept {
+  std::erase_if(candidates, [](const pixmap* candidate) {
+    return candidate->_pins != 0 || !candidate->_texture || candidate->_drawn + 1 >= frame;
+  });
+
+  std::ranges::sort(candidates);
+  const auto [first, last] = std::ranges::unique(candidates);
+  candidates.erase(first, last);
+
+  std::ranges::sort(candidates, {}, &pixmap::_drawn);
+
+  for (auto* const candidate : candidates) {
+    if (allocated <= ceiling) {
+      break;
+    }
+
+    std::println("[pixmap] evicted {} ({} KiB)", candidate->_filename, candidate->bytes() / 1024);
+    candidate->release();
+  }
+}
+
+void pixmap::reload(std::span<pixmap* const> pixmaps) noexcept {
+  auto missing = 0uz;
+  for (const auto* const candidate : pixmaps) {
+    if (candidate->_texture) {
+      continue;
+    }
+
+    try {
+      prefetch(candidate->_filename);
+    } catch (const std::exception& e) {
+      std::println(stderr, "[pixmap] failed to prefetch {}: {}", candidate->_filename, e.what());
+    }
+
+    ++missing;
+  }
+
+  if (missing == 0) [[likely]] {
+    return;
+  }
+
+  std::println("[pixmap] reloading {} textures", missing);
+}
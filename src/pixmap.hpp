@@ -6,9 +6,27 @@
 
 class pixmap final {
 public:
+  struct image final {
+    int width{0};
+    int height{0};
+    bool premultiplied{false};
+    std::unique_ptr<uint8_t[]> pixels;
+  };
+
   pixmap() = delete;
   explicit pixmap(std::string_view filename);
-  ~pixmap() = default;
+  ~pixmap() noexcept;
+
+  pixmap(const pixmap&) = delete;
+  pixmap& operator=(const pixmap&) = delete;
+  pixmap(pixmap&&) = delete;
+  pixmap& operator=(pixmap&&) = delete;
+
+  [[nodiscard]] static image decode(std::string_view filename);
+
+  static bool prefetch(std::string_view filename);
+
+  static void discard(std::string_view filename) noexcept;
 
   void draw(
     const float sx, const float sy, const float sw, const float sh,
@@ -24,9 +42,44 @@ public:
 
   int height() const noexcept;
 
+  [[nodiscard]] size_t bytes() const noexcept;
+
+  [[nodiscard]] bool resident() const noexcept;
+
+  void restore() const noexcept;
+
+  void pin() noexcept;
+
+  void unpin() noexcept;
+
+  [[nodiscard]] static size_t usage() noexcept;
+
+  static void set_budget(size_t bytes) noexcept;
+
+  static void advance() noexcept;
+
+  [[nodiscard]] static bool exceeded() noexcept;
+
+  static void collect(std::vector<pixmap*>& candidates) noexcept;
+
+  static void reload(std::span<pixmap* const> pixmaps) noexcept;
+
 private:
+  [[nodiscard]] static image fetch(std::string_view filename);
+
+  [[nodiscard]] static image unbake(std::string_view filename);
+
+  void upload(const image& decoded) const;
+
+  void release() noexcept;
+
+  std::string _filename;
+
   int _width;
   int _height;
 
-  std::unique_ptr<SDL_Texture, SDL_Deleter> _texture;
+  uint32_t _pins{0};
+  mutable uint64_t _drawn{0};
+
+  mutable std::unique_ptr<SDL_Texture, SDL_Deleter> _texture;
 };
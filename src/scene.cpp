@@ -1,26 +1,42 @@
 #include "scene.hpp"
 
+#include "assetmanager.hpp"
+#include "baked.hpp"
 #include "components.hpp"
 #include "fontpool.hpp"
 #include "geometry.hpp"
+#include "io.hpp"
 #include "objectproxy.hpp"
 #include "particlepool.hpp"
 #include "physics.hpp"
 #include "pixmap.hpp"
+#include "scheduler.hpp"
+#include "scriptcache.hpp"
 
-scene::scene(std::string_view name, unmarshal::json node, std::shared_ptr<::fontpool> fontpool, sol::environment environment)
+namespace {
+std::string definition(const std::string& filename) {
+  if (auto path = baked::sibling(filename, baked::definition_extension); io::exists(path)) {
+    return path;
+  }
+
+  return filename;
+}
+}
+
+scene::scene(std::string_view name, unmarshal::json node, std::shared_ptr<::assetmanager> assets, std::shared_ptr<::fontpool> fontpool, sol::environment environment)
     : _name(name),
       _world(node),
+      _assets(std::move(assets)),
       _environment(std::move(environment)),
-      _soundpool(name),
-      _objectpool(_registry, _world, name, _environment) {
-  (void)fontpool;
-  _view = _registry.view<tickable>();
-  _hits.reserve(16);
-  _hovering.reserve(16);
+      _soundpool(name, *_assets),
+      _objectpool(_registry, _world, *_assets, name, _environment),
+      _document(std::move(node)) {
+  _view = _registry.view<tickable>(entt::exclude<dormant>);
 
   _registry.ctx().emplace<interning>();
   _registry.ctx().emplace<scripting>(_registry);
+  _registry.ctx().emplace<recycler>();
+  _registry.ctx().emplace<scheduler>(_registry);
   _registry.ctx().emplace<physics::world*>(&_world);
   _registry.ctx().emplace<renderstate>();
 
@@ -28,50 +44,104 @@ scene::scene(std::string_view name, unmarshal::json node, std::shared_ptr<::font
 
   _camera = {0, 0, screen::width(), screen::height()};
 
-  if (auto sounds = node["sounds"]) {
+  const auto& document = _document;
+
+  if (auto sounds = document["sounds"]) {
     sounds.foreach([this](unmarshal::json node) {
-      _soundpool.add(node.get<std::string_view>());
+      enqueue([this, node] {
+        _soundpool.add(node.get<std::string_view>());
+      });
     });
   }
 
-  if (auto fonts = node["fonts"]) {
-    fonts.foreach([&fontpool](unmarshal::json node) {
-      fontpool->get(node.get<std::string_view>());
+  if (auto fonts = document["fonts"]) {
+    fonts.foreach([this, &fontpool](unmarshal::json node) {
+      enqueue([fontpool, node] {
+        fontpool->get(node.get<std::string_view>());
+      });
     });
   }
 
-  if (auto layer = node["layer"]) {
+  if (auto layer = document["layer"]) {
     const auto type = layer["type"].get<std::string_view>();
 
     if (type == "tilemap") {
-      auto content = layer["content"].get<std::string_view>();
-      _layer.emplace<::tilemap>(content, _world);
+      const auto content = layer["content"].get<std::string_view>();
+      preread(definition(std::format("tilemaps/{}.json", content)));
+      prefetch(std::format("blobs/tilemaps/{}.png", content));
+
+      enqueue([this, content] {
+        _layer.emplace<::tilemap>(content, _world, *_assets);
+      });
     }
 
     else {
-      _layer = std::make_shared<pixmap>(std::format("blobs/{}/background.png", name));
+      prefetch(std::format("blobs/{}/background.png", name));
 
-      const auto width = node["width"].get<float>();
-      const auto height = node["height"].get<float>();
-      _camera = quad{0, 0, width, height};
+      const auto width = document["width"].get<float>();
+      const auto height = document["height"].get<float>();
+
+      enqueue([this, width, height] {
+        _layer = _assets->pixmap(std::format("blobs/{}/background.png", _name));
+        _camera = quad{0, 0, width, height};
+      });
     }
   }
 
-  if (auto objects = node["objects"]) {
+  if (auto objects = document["objects"]) {
+    boost::unordered_flat_map<std::string_view, bool> kinds;
+
+    objects.foreach([&](unmarshal::json node) {
+      const auto type = node["type"].get<std::string_view>("object");
+      const auto kind = node["kind"].get<std::string_view>();
+      if (!kinds.try_emplace(kind, true).second) {
+        return;
+      }
+
+      if (type == "particle") {
+        if (const auto filename = std::format("particles/{}.json", kind); !_assets->contains(filename)) {
+          preread(definition(filename));
+          prefetch(std::format("blobs/particles/{}.png", kind));
+        }
+
+        return;
+      }
+
+      if (const auto filename = std::format("objects/{}/{}.json", name, kind); !_assets->contains(filename)) {
+        preread(definition(filename));
+        prefetch(std::format("blobs/{}/{}.png", name, kind));
+      }
+
+      if (const auto filename = std::format("objects/{}/{}.lua", name, kind); !scriptcache::contains(filename) && io::exists(filename)) {
+        preread(filename);
+      }
+    });
+
     auto z = 0;
     objects.foreach([this, &z](unmarshal::json node) {
       const auto type = node["type"].get<std::string_view>("object");
       if (type == "particle") {
-        _particlepool.add(std::move(node), z++);
+        enqueue([this, node, z] { _particlepool.add(node, z); });
       } else {
-        _objectpool.add(std::move(node), z++);
+        enqueue([this, node, z] { _objectpool.add(node, z); });
       }
+
+      ++z;
     });
 
-    _objectpool.sort();
+    enqueue([this] { _objectpool.sort(); });
+  }
+
+  if (const auto filename = std::format("scenes/{}.lua", name); !scriptcache::contains(filename) && io::exists(filename)) {
+    preread(filename);
   }
 }
 
+scene::~scene() noexcept {
+  unpin();
+  discard();
+}
+
 void scene::update(float delta) {
   const auto now = SDL_GetTicks();
 
@@ -85,16 +155,22 @@ void scene::update(float delta) {
 
   _animationsystem.update(now);
 
+  _tweensystem.update(now);
+
   _velocitysystem.update(delta);
 
   _physicssystem.update(delta);
 
+  hover();
+
   _soundpool.update(delta);
 
   _particlepool.update(delta);
 
   _scriptsystem.update(delta);
 
+  _registry.ctx().get<scheduler>().update(now);
+
   _rendersystem.update();
 
   auto& state = _registry.ctx().get<renderstate>();
@@ -113,7 +189,7 @@ void scene::draw() const noexcept {
     }
   }, _layer);
 
-  for (auto&& [entity, rn] : _registry.view<renderable>().each()) {
+  for (auto&& [entity, rn] : _registry.view<renderable>(entt::exclude<dormant>).each()) {
     if (!rn.visible) [[unlikely]] continue;
 
     switch (rn.kind) {
@@ -152,7 +228,7 @@ std::string_view scene::name() const noexcept {
   return _name;
 }
 
-void scene::populate(sol::table& pool) const {
+void scene::populate(sol::table& pool) {
   sol::state_view lua(pool.lua_state());
 
   lua.new_enum(
@@ -169,10 +245,10 @@ void scene::populate(sol::table& pool) const {
   );
 
   const auto raycast = [&](const vec2& origin, float angle, float distance, std::optional<physics::category> mask) {
-    boost::container::small_vector<std::shared_ptr<objectproxy>, 16> result;
+    boost::container::small_vector<objectproxy, 16> result;
     _world.raycast(origin, angle, distance, mask.value_or(physics::category::all), [&](entt::entity entity) {
-      if (const auto* proxy = _registry.try_get<std::shared_ptr<objectproxy>>(entity)) {
-        result.push_back(*proxy);
+      if (_registry.all_of<metadata>(entity)) {
+        result.emplace_back(entity, _registry);
       }
     });
 
@@ -190,11 +266,187 @@ void scene::populate(sol::table& pool) const {
     )
   );
 
+  const auto apply = [this](objectproxy& proxy, const sol::optional<sol::table>& overrides) {
+    if (overrides) {
+      sol::state_view lua(overrides->lua_state());
+      auto handle = sol::make_object(lua, proxy).as<sol::userdata>();
+      overrides->for_each([&](const sol::object& key, const sol::object& value) {
+        handle[key] = value;
+      });
+    }
+
+    _registry.ctx().get<scripting>().spawn(proxy.entity());
+  };
+
+  lua["spawn"] = sol::overload(
+    [this, apply](std::string_view kind, float x, float y, sol::optional<sol::table> overrides) {
+      auto proxy = _objectpool.spawn(kind, {x, y});
+      apply(proxy, overrides);
+      return proxy;
+    },
+    [this, apply](std::string_view kind, sol::table points, sol::optional<sol::table> overrides) {
+      const auto size = points.size();
+      std::vector<vec2> positions;
+      positions.reserve(size);
+      for (auto i = 1uz; i <= size; ++i) {
+        const sol::object point = points[i];
+        if (point.is<vec2>()) {
+          positions.emplace_back(point.as<vec2>());
+          continue;
+        }
+
+        const auto table = point.as<sol::table>();
+        positions.push_back({table.get_or("x", table.get_or(1, .0f)), table.get_or("y", table.get_or(2, .0f))});
+      }
+
+      std::vector<objectproxy> result;
+      _objectpool.spawn(kind, positions, result);
+      for (auto& proxy : result) {
+        apply(proxy, overrides);
+      }
+
+      return sol::as_table(std::move(result));
+    }
+  );
+
+  auto& scheduler = _registry.ctx().get<::scheduler>();
+  lua["async"] = [&scheduler](sol::protected_function fn, sol::variadic_args args) {
+    return scheduler.start(std::move(fn), args);
+  };
+
+  lua["cancel"] = [&scheduler](uint32_t id) {
+    scheduler.cancel(id);
+  };
+
   _soundpool.populate(pool);
   _particlepool.populate(pool);
   _objectpool.populate(pool);
 }
 
+void scene::enqueue(std::function<void()>&& fn) {
+  _steps.emplace_back(std::move(fn));
+  ++_total;
+}
+
+std::vector<pixmap*> scene::textures() const {
+  std::vector<pixmap*> result;
+
+  if (const auto* layer = std::get_if<std::shared_ptr<pixmap>>(&_layer)) {
+    result.emplace_back(layer->get());
+  } else if (const auto* layer = std::get_if<tilemap>(&_layer)) {
+    result.emplace_back(layer->atlas());
+  }
+
+  _objectpool.textures(result);
+  _particlepool.textures(result);
+
+  std::ranges::sort(result);
+  const auto [first, last] = std::ranges::unique(result);
+  result.erase(first, last);
+
+  return result;
+}
+
+size_t scene::footprint() const {
+  auto total = 0uz;
+  for (const auto* const texture : textures()) {
+    total += texture->bytes();
+  }
+
+  return total;
+}
+
+void scene::pin() {
+  unpin();
+
+  if (const auto* layer = std::get_if<std::shared_ptr<pixmap>>(&_layer)) {
+    _pinned.emplace_back(layer->get());
+  } else if (const auto* layer = std::get_if<tilemap>(&_layer)) {
+    _pinned.emplace_back(layer->atlas());
+  }
+
+  _particlepool.textures(_pinned);
+
+  for (auto* const texture : _pinned) {
+    texture->pin();
+  }
+
+  _objectpool.pin();
+
+  pixmap::reload(textures());
+}
+
+void scene::unpin() noexcept {
+  for (auto* const texture : _pinned) {
+    texture->unpin();
+  }
+
+  _pinned.clear();
+
+  _objectpool.unpin();
+}
+
+bool scene::visited() const noexcept {
+  return _visited;
+}
+
+void scene::prefetch(std::string_view filename) {
+  if (_assets->contains(filename)) {
+    return;
+  }
+
+  if (pixmap::prefetch(filename)) {
+    _prefetched.emplace_back(filename);
+  }
+}
+
+void scene::preread(std::string_view filename) {
+  if (io::prefetch(filename)) {
+    _preread.emplace_back(filename);
+  }
+}
+
+void scene::discard() noexcept {
+  for (const auto& filename : _prefetched) {
+    pixmap::discard(filename);
+  }
+
+  for (const auto& filename : _preread) {
+    io::discard(filename);
+  }
+
+  _prefetched.clear();
+  _preread.clear();
+}
+
+bool scene::advance(uint64_t deadline) {
+  while (!_steps.empty()) {
+    const auto step = std::move(_steps.front());
+    _steps.pop_front();
+    step();
+
+    if (SDL_GetPerformanceCounter() >= deadline) [[unlikely]] {
+      break;
+    }
+  }
+
+  if (_steps.empty()) {
+    _document = unmarshal::json{};
+    discard();
+  }
+
+  return _steps.empty();
+}
+
+bool scene::ready() const noexcept {
+  return _steps.empty();
+}
+
+float scene::progress() const noexcept {
+  if (_total == 0) [[unlikely]] return 1.f;
+  return static_cast<float>(_total - _steps.size()) / static_cast<float>(_total);
+}
+
 void scene::set_onenter(std::function<void()>&& fn) {
   _onenter = std::move(fn);
 }
@@ -233,15 +485,22 @@ void scene::set_ontick(sol::protected_function&& fn) {
 
 void scene::on_enter() {
   assert(_onenter && "on_enter callback must be set");
+  _visited = true;
   _onenter();
 
-  for (auto&& [entity, sc] : _registry.view<scriptable>().each()) {
+  for (auto&& [entity, sc] : _registry.view<scriptable>(entt::exclude<dormant>).each()) {
+    if (sc.spawned) continue;
+
+    sc.spawned = true;
     sc.on_spawn();
   }
 }
 
 void scene::on_leave() {
-  for (auto&& [entity, sc] : _registry.view<scriptable>().each()) {
+  for (auto&& [entity, sc] : _registry.view<scriptable>(entt::exclude<dormant>).each()) {
+    if (!sc.spawned) continue;
+
+    sc.spawned = false;
     sc.on_dispose();
   }
 
@@ -268,27 +527,38 @@ void scene::on_touch(float x, float y) {
   }
 }
 
-void scene::on_motion(float x, float y) {
+void scene::on_motion(float x, float y, float dx, float dy) {
+  _pointer.emplace(x, y);
+
+  _onmotion(x, y, dx, dy);
+}
+
+void scene::hover() {
+  if (!_pointer) {
+    return;
+  }
+
+  const auto [x, y] = *_pointer;
+  _pointer.reset();
+
   _hits.clear();
   query(x, y, _hits);
 
   for (const auto entity : _hovering) {
-    if (_hits.contains(entity)) continue;
+    if (std::ranges::binary_search(_hits, entity)) continue;
     if (const auto* h = _registry.try_get<hoverable>(entity)) {
       h->on_unhover();
     }
   }
 
   for (const auto entity : _hits) {
-    if (_hovering.contains(entity)) continue;
+    if (std::ranges::binary_search(_hovering, entity)) continue;
     if (const auto* h = _registry.try_get<hoverable>(entity)) {
       h->on_hover();
     }
   }
 
   _hovering.swap(_hits);
-
-  _onmotion(x, y);
 }
 
 void scene::on_key_press(int32_t code) {
@@ -302,6 +572,8 @@ void scene::on_key_release(int32_t code) {
 void scene::on_tick(uint8_t tick) {
   _ontick(tick);
 
+  _registry.ctx().get<scheduler>().tick();
+
   for (auto&& [entity, t] : _view.each()) {
     t.on_tick(tick);
   }
@@ -11,9 +11,9 @@
 
 class scene final {
 public:
-  scene(std::string_view name, unmarshal::json node, std::shared_ptr<::fontpool> fontpool, sol::environment environment);
+  scene(std::string_view name, unmarshal::json node, std::shared_ptr<::assetmanager> assets, std::shared_ptr<::fontpool> fontpool, sol::environment environment);
 
-  ~scene() noexcept = default;
+  ~scene() noexcept;
 
   void update(float delta);
 
@@ -21,7 +21,25 @@ public:
 
   [[nodiscard]] std::string_view name() const noexcept;
 
-  void populate(sol::table& pool) const;
+  void populate(sol::table& pool);
+
+  void enqueue(std::function<void()>&& fn);
+
+  bool advance(uint64_t deadline);
+
+  [[nodiscard]] bool ready() const noexcept;
+
+  [[nodiscard]] float progress() const noexcept;
+
+  [[nodiscard]] std::vector<pixmap*> textures() const;
+
+  [[nodiscard]] size_t footprint() const;
+
+  void pin();
+
+  void unpin() noexcept;
+
+  [[nodiscard]] bool visited() const noexcept;
 
   void set_onenter(std::function<void()>&& fn);
   void set_onloop(sol::protected_function&& fn);
@@ -36,20 +54,33 @@ public:
   void on_enter();
   void on_leave();
   void on_touch(float x, float y);
-  void on_motion(float x, float y);
+  void on_motion(float x, float y, float dx, float dy);
   void on_key_press(int32_t code);
   void on_key_release(int32_t code);
   void on_tick(uint8_t tick);
 
 private:
-  void query(float x, float y, std::unordered_set<entt::entity>& out) const {
+  using hits = boost::container::small_vector<entt::entity, 8>;
+
+  void query(float x, float y, hits& out) const {
     _world.query_aabb(physics::aabb(x - epsilon, y - epsilon, epsilon * 2.0f, epsilon * 2.0f), physics::category::all, [&out](b2ShapeId, entt::entity entity) {
-      out.emplace(entity);
+      out.emplace_back(entity);
       return true;
     });
+
+    std::ranges::sort(out);
+    out.erase(std::ranges::unique(out).begin(), out.end());
   }
 
-  using view_type = decltype(std::declval<entt::registry&>().view<tickable>());
+  void hover();
+
+  void prefetch(std::string_view filename);
+
+  void preread(std::string_view filename);
+
+  void discard() noexcept;
+
+  using view_type = decltype(std::declval<entt::registry&>().view<tickable>(entt::exclude<dormant>));
 
   boost::static_string<48> _name;
 
@@ -62,6 +93,7 @@ private:
   physicssystem _physicssystem{_registry, _world};
   rendersystem _rendersystem{_registry};
   scriptsystem _scriptsystem{_registry};
+  tweensystem _tweensystem{_registry};
   velocitysystem _velocitysystem{_registry};
 
   std::variant<std::monostate, std::shared_ptr<pixmap>, tilemap> _layer;
@@ -77,11 +109,23 @@ private:
   std::function<void()> _onenter;
   std::function<void()> _onleave;
 
-  std::unordered_set<entt::entity> _hits;
-  std::unordered_set<entt::entity> _hovering;
+  hits _hits;
+  hits _hovering;
+  std::optional<std::pair<float, float>> _pointer;
 
+  std::shared_ptr<::assetmanager> _assets;
   sol::environment _environment;
   soundpool _soundpool;
-  particlepool _particlepool{_registry};
+  particlepool _particlepool{_registry, *_assets};
   objectpool _objectpool;
+
+  unmarshal::json _document;
+  std::deque<std::function<void()>> _steps;
+  size_t _total{0};
+
+  std::vector<std::string> _prefetched;
+  std::vector<std::string> _preread;
+
+  std::vector<pixmap*> _pinned;
+  bool _visited{false};
 };
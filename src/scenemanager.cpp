@@ -1,21 +1,70 @@
 #include "scenemanager.hpp"
 
+#include "assetmanager.hpp"
 #include "event.hpp"
 #include "io.hpp"
+#include "pixmap.hpp"
 #include "scene.hpp"
+#include "stopwatch.hpp"
 #include "textinput.hpp"
 
-std::shared_ptr<scene> scenemanager::load(std::string_view name) {
+std::shared_ptr<scene> scenemanager::load(std::string_view name, std::function<void(::scene&)> onready) {
+  auto scene = create(name, std::move(onready));
+  if (!scene) [[unlikely]] {
+    return nullptr;
+  }
+
+  scene->advance(std::numeric_limits<uint64_t>::max());
+
+  return scene;
+}
+
+std::shared_ptr<scene> scenemanager::preload(std::string_view name, std::function<void(::scene&)> onready) {
+  auto scene = create(name, std::move(onready));
+  if (!scene) [[unlikely]] {
+    return nullptr;
+  }
+
+  stopwatch::begin();
+  _loading.emplace_back(scene);
+
+  return scene;
+}
+
+std::shared_ptr<scene> scenemanager::create(std::string_view name, std::function<void(::scene&)> onready) {
   const auto [it, inserted] = _scene_mapping.try_emplace(name);
-  if (inserted) {
-    auto json = unmarshal::parse(io::read(std::format("scenes/{}.json", name)));
+  if (!inserted) {
+    return nullptr;
+  }
+
+  try {
+    const auto filename = std::format("scenes/{}.json", name);
+    const auto buffer = io::read(filename);
+    auto json = stopwatch::measure(stage::parse, filename, [&] { return unmarshal::parse(buffer); });
 
     sol::environment environment(_environment.lua_state(), sol::create, _environment);
 
-    return it->second = std::make_shared<scene>(name, std::move(json), _fontpool, std::move(environment));
+    it->second = std::make_shared<::scene>(name, std::move(json), _assetmanager, _fontpool, std::move(environment));
+  } catch (...) {
+    _scene_mapping.erase(it);
+    throw;
+  }
+
+  auto scene = it->second;
+  if (onready) {
+    scene->enqueue([onready = std::move(onready), ptr = scene.get()] { onready(*ptr); });
+  }
+
+  return scene;
+}
+
+float scenemanager::progress(std::string_view name) const {
+  const auto it = _scene_mapping.find(name);
+  if (it == _scene_mapping.end()) [[unlikely]] {
+    return .0f;
   }
 
-  return nullptr;
+  return it->second->progress();
 }
 
 std::string_view scenemanager::current() const {
@@ -53,30 +102,70 @@ std::vector<std::string> scenemanager::destroy(std::string_view name) {
   const auto scenes = query(name);
 
   for (const auto& scene : scenes) {
+    const auto cancelled = std::erase_if(_loading, [&scene](const auto& pending) { return pending->name() == scene; });
+    for (auto i = 0uz; i < cancelled; ++i) {
+      stopwatch::end();
+    }
+
     if (_scene_mapping.erase(scene) > 0) {
       std::println("[scenemanager] destroyed {}", scene);
     }
   }
 
+  _assetmanager->trim();
+
   return scenes;
 }
 
 void scenemanager::update(float delta) {
-  if (_pending) [[unlikely]] {
+  if (_pending && !_pending->ready() && !_loading.empty() && _loading.front() != _pending) [[unlikely]] {
+    std::erase(_loading, _pending);
+    _loading.emplace_front(_pending);
+  }
+
+  if (!_loading.empty()) [[unlikely]] {
+    const auto budget = SDL_GetPerformanceFrequency() * PRELOAD_BUDGET_MS / 1000;
+    const auto& scene = _loading.front();
+    if (scene->advance(SDL_GetPerformanceCounter() + budget)) {
+      std::println("[scenemanager] preloaded {}", scene->name());
+      _loading.pop_front();
+      stopwatch::end();
+    }
+  }
+
+  if (_pending && _pending->ready()) [[unlikely]] {
     if (_scene) [[likely]] {
       std::println("[scenemanager] left {}", _scene->name());
       _scene->on_leave();
+      _scene->unpin();
     }
 
     _textinput->off();
 
     _scene = std::move(_pending);
 
-    std::println("[scenemanager] entered {}", _scene->name());
+    _scene->pin();
+
+    std::println("[scenemanager] entered {} ({} KiB of textures, {} KiB in total)", _scene->name(), _scene->footprint() / 1024, pixmap::usage() / 1024);
 
     _scene->on_enter();
   }
 
+  pixmap::advance();
+
+  if (pixmap::exceeded()) [[unlikely]] {
+    std::vector<pixmap*> candidates;
+    for (const auto& [_, scene] : _scene_mapping) {
+      if (scene == _scene || scene == _pending || !scene->ready() || !scene->visited()) {
+        continue;
+      }
+
+      std::ranges::copy(scene->textures(), std::back_inserter(candidates));
+    }
+
+    pixmap::collect(candidates);
+  }
+
   if (!_scene) [[unlikely]] return;
   _scene->update(delta);
 }
@@ -111,13 +200,17 @@ void scenemanager::on_mouse_release(const event::mouse::button& event) {
 
 void scenemanager::on_mouse_motion(const event::mouse::motion& event) {
   if (!_scene) [[unlikely]] return;
-  _scene->on_motion(event.x, event.y);
+  _scene->on_motion(event.x, event.y, event.dx, event.dy);
 }
 
 void scenemanager::set_runtime(sol::state_view runtime) {
   _environment = sol::environment(runtime, sol::create, runtime.globals());
 }
 
+void scenemanager::set_assetmanager(std::shared_ptr<::assetmanager> assetmanager) noexcept {
+  _assetmanager = std::move(assetmanager);
+}
+
 void scenemanager::set_fontpool(std::shared_ptr<::fontpool> fontpool) noexcept {
   _fontpool = std::move(fontpool);
 }
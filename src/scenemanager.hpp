@@ -8,7 +8,11 @@ public:
 
   ~scenemanager() noexcept = default;
 
-  std::shared_ptr<::scene> load(std::string_view name);
+  std::shared_ptr<::scene> load(std::string_view name, std::function<void(::scene&)> onready = {});
+
+  std::shared_ptr<::scene> preload(std::string_view name, std::function<void(::scene&)> onready = {});
+
+  [[nodiscard]] float progress(std::string_view name) const;
 
   std::string_view current() const;
 
@@ -26,6 +30,8 @@ public:
 
   void set_runtime(sol::state_view runtime);
 
+  void set_assetmanager(std::shared_ptr<::assetmanager> assetmanager) noexcept;
+
   void set_fontpool(std::shared_ptr<::fontpool> fontpool) noexcept;
 
   void set_textinput(std::shared_ptr<::textinput> textinput) noexcept;
@@ -38,10 +44,14 @@ protected:
   virtual void on_mouse_motion(const event::mouse::motion& event) override;
 
 private:
+  std::shared_ptr<::scene> create(std::string_view name, std::function<void(::scene&)> onready);
+
   sol::environment _environment;
+  std::shared_ptr<::assetmanager> _assetmanager;
   std::shared_ptr<::fontpool> _fontpool;
   boost::unordered_flat_map<std::string, std::shared_ptr<::scene>, transparent_string_hash, std::equal_to<>> _scene_mapping;
   std::shared_ptr<::scene> _scene;
   std::shared_ptr<::scene> _pending;
+  std::deque<std::shared_ptr<::scene>> _loading;
   std::shared_ptr<::textinput> _textinput;
 };
@@ -0,0 +1,176 @@
+#include "scheduler.hpp"
+
+#include "components.hpp"
+
+namespace {
+enum class condition : uint8_t {
+  frame,
+  time,
+  tick,
+  animation,
+};
+
+struct pending final {
+  condition kind{condition::frame};
+  uint64_t value{0};
+  entt::entity entity{entt::null};
+};
+
+lua_State* current{nullptr};
+pending request;
+
+void expect(lua_State* L) {
+  if (L != current) [[unlikely]] {
+    throw std::runtime_error("[scheduler] wait called outside of an async task");
+  }
+}
+}
+
+scheduler::scheduler(entt::registry& registry) noexcept
+    : _registry(registry) {
+  _tasks.reserve(16);
+}
+
+uint32_t scheduler::start(sol::protected_function fn, sol::variadic_args args) {
+  const auto id = ++_next;
+
+  auto thread = sol::thread::create(fn.lua_state());
+  sol::coroutine coroutine(thread.thread_state(), fn);
+  _tasks.emplace(id, std::make_unique<task>(std::move(thread), std::move(coroutine)));
+
+  boost::container::small_vector<sol::object, 4> arguments(args.begin(), args.end());
+  resume(id, arguments);
+
+  return id;
+}
+
+void scheduler::cancel(uint32_t id) noexcept {
+  const auto it = _tasks.find(id);
+  if (it == _tasks.end()) {
+    return;
+  }
+
+  if (it->second->running) {
+    it->second->cancelled = true;
+    return;
+  }
+
+  _tasks.erase(it);
+}
+
+void scheduler::wake(std::span<const uint32_t> ids) {
+  _ready.insert(_ready.end(), ids.begin(), ids.end());
+}
+
+void scheduler::update(uint64_t now) {
+  _due.clear();
+  _due.swap(_ready);
+  drain(_timers, now);
+  dispatch();
+}
+
+void scheduler::tick() {
+  ++_ticks;
+
+  _due.clear();
+  drain(_tickers, _ticks);
+  dispatch();
+}
+
+size_t scheduler::size() const noexcept {
+  return _tasks.size();
+}
+
+void scheduler::sleep(lua_State* L, uint64_t ms) {
+  expect(L);
+  request = {condition::time, ms, entt::null};
+}
+
+void scheduler::sleep_ticks(lua_State* L, uint64_t ticks) {
+  expect(L);
+  request = {condition::tick, std::max(ticks, uint64_t{1}), entt::null};
+}
+
+void scheduler::await(lua_State* L, entt::entity entity) {
+  expect(L);
+  request = {condition::animation, 0, entity};
+}
+
+void scheduler::resume(uint32_t id, std::span<const sol::object> args) {
+  const auto it = _tasks.find(id);
+  if (it == _tasks.end()) {
+    return;
+  }
+
+  auto& t = *it->second;
+  const auto thread = t.thread;
+  auto coroutine = t.coroutine;
+
+  const auto outer = std::exchange(request, pending{});
+  defer(request = outer);
+
+  t.running = true;
+  const auto previous = std::exchange(current, thread.thread_state());
+  auto result = coroutine(sol::as_args(args));
+  current = previous;
+  t.running = false;
+
+  if (!result.valid()) [[unlikely]] {
+    sol::error err = result;
+    _tasks.erase(id);
+    throw std::runtime_error(std::format("[scheduler] {}", err.what()));
+  }
+
+  if (t.cancelled || result.status() != sol::call_status::yielded) {
+    _tasks.erase(id);
+    return;
+  }
+
+  park(id);
+}
+
+void scheduler::dispatch() {
+  for (auto i = 0uz; i < _due.size(); ++i) {
+    try {
+      resume(_due[i]);
+    } catch (...) {
+      _ready.insert(_ready.end(), _due.begin() + static_cast<std::ptrdiff_t>(i) + 1, _due.end());
+      throw;
+    }
+  }
+}
+
+void scheduler::park(uint32_t id) {
+  switch (request.kind) {
+    case condition::frame:
+      _ready.push_back(id);
+      return;
+
+    case condition::time:
+      _timers.emplace(SDL_GetTicks() + request.value, id);
+      return;
+
+    case condition::tick:
+      _tickers.emplace(_ticks + request.value, id);
+      return;
+
+    case condition::animation: {
+      const auto entity = request.entity;
+      const auto* pb = _registry.valid(entity) ? _registry.try_get<playback>(entity) : nullptr;
+      if (!pb || pb->finished || !pb->timeline || !pb->timeline->oneshot) {
+        _ready.push_back(id);
+        return;
+      }
+
+      _registry.get_or_emplace<awaiter>(entity).tasks.push_back(id);
+      return;
+    }
+  }
+}
+
+void scheduler::drain(heap& queue, uint64_t now) {
+  while (!queue.empty() && queue.top().first <= now) {
+    _due.push_back(queue.top().second);
+    queue.pop();
+  }
+}
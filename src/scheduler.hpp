@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common.hpp"
+
+struct awaiter final {
+  boost::container::small_vector<uint32_t, 2> tasks;
+};
+
+class scheduler final {
+public:
+  explicit scheduler(entt::registry& registry) noexcept;
+
+  uint32_t start(sol::protected_function fn, sol::variadic_args args);
+
+  void cancel(uint32_t id) noexcept;
+
+  void wake(std::span<const uint32_t> ids);
+
+  void update(uint64_t now);
+
+  void tick();
+
+  [[nodiscard]] size_t size() const noexcept;
+
+  static void sleep(lua_State* L, uint64_t ms);
+
+  static void sleep_ticks(lua_State* L, uint64_t ticks);
+
+  static void await(lua_State* L, entt::entity entity);
+
+private:
+  struct task final {
+    sol::thread thread;
+    sol::coroutine coroutine;
+    bool running{false};
+    bool cancelled{false};
+  };
+
+  using entry = std::pair<uint64_t, uint32_t>;
+  using heap = std::priority_queue<entry, std::vector<entry>, std::greater<>>;
+
+  void resume(uint32_t id, std::span<const sol::object> args = {});
+
+  void park(uint32_t id);
+
+  void dispatch();
+
+  void drain(heap& queue, uint64_t now);
+
+  entt::registry& _registry;
+  boost::unordered_flat_map<uint32_t, std::unique_ptr<task>> _tasks;
+  heap _timers;
+  heap _tickers;
+  std::vector<uint32_t> _ready;
+  std::vector<uint32_t> _due;
+  uint64_t _ticks{0};
+  uint32_t _next{0};
+};
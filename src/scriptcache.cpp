@@ -0,0 +1,73 @@
+#include "scriptcache.hpp"
+
+#include "baked.hpp"
+#include "io.hpp"
+#include "stopwatch.hpp"
+
+namespace {
+boost::unordered_flat_map<std::string, std::shared_ptr<const std::string>, transparent_string_hash, std::equal_to<>> chunks;
+
+std::string dump(lua_State* L, sol::protected_function& function, size_t reserve) {
+  std::string result;
+  result.reserve(reserve);
+
+  function.push();
+  lua_dump(L, [](lua_State*, const void* data, size_t size, void* userdata) -> int {
+    static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
+    return 0;
+  }, &result, 0);
+  lua_pop(L, 1);
+
+  return result;
+}
+
+std::shared_ptr<const std::string> precompiled(sol::state_view& lua, std::string_view filename) {
+  const auto path = baked::sibling(filename, baked::bytecode_extension);
+  if (!io::exists(path)) {
+    return nullptr;
+  }
+
+  const auto buffer = io::read(path);
+  stopwatch watch(stage::compile, path);
+
+  std::string_view code{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+  if (const auto result = lua.load(code, std::format("@{}", filename), sol::load_mode::binary); !result.valid()) {
+    sol::error err = result;
+    std::println("[scriptcache] ignoring {}: {}", path, err.what());
+    return nullptr;
+  }
+
+  return std::make_shared<const std::string>(code);
+}
+}
+
+bool scriptcache::contains(std::string_view filename) noexcept {
+  return chunks.contains(filename);
+}
+
+std::shared_ptr<const std::string> scriptcache::compile(sol::state_view lua, std::string_view filename) {
+  if (const auto it = chunks.find(filename); it != chunks.end()) [[likely]] {
+    return it->second;
+  }
+
+  auto code = precompiled(lua, filename);
+  if (!code) {
+    const auto buffer = io::read(filename);
+    stopwatch watch(stage::compile, filename);
+
+    std::string_view script{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+    const auto result = lua.load(script, std::format("@{}", filename), sol::load_mode::text);
+    verify(result);
+
+    auto function = result.get<sol::protected_function>();
+    code = std::make_shared<const std::string>(dump(lua.lua_state(), function, buffer.size() * 7 / 2));
+  }
+
+  chunks.emplace(filename, code);
+  return code;
+}
+
+sol::load_result scriptcache::load(sol::state_view lua, std::string_view filename) {
+  const auto code = compile(lua, filename);
+  return lua.load(*code, std::format("@{}", filename), sol::load_mode::binary);
+}
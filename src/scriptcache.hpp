@@ -0,0 +1,12 @@
+#pragma once
+
+#include "common.hpp"
+
+class scriptcache final {
+public:
+  [[nodiscard]] static bool contains(std::string_view filename) noexcept;
+
+  [[nodiscard]] static std::shared_ptr<const std::string> compile(sol::state_view lua, std::string_view filename);
+
+  [[nodiscard]] static sol::load_result load(sol::state_view lua, std::string_view filename);
+};
@@ -22,6 +22,8 @@ inline constexpr auto debugger =
 #endif
 ;
 
+inline constexpr auto KEY_HANDLE = 1 << 12;
+
 static int on_panic(lua_State* L) {
   const auto* message = lua_tostring(L, -1);
   throw std::runtime_error(std::format("Lua panic: {}", message));
@@ -30,49 +32,108 @@ static int on_panic(lua_State* L) {
 static sol::object searcher(sol::this_state state, std::string_view module) {
   sol::state_view lua{state};
 
-  const auto filename = std::format("scripts/{}.lua", module);
-  const auto buffer = io::read(filename);
-  std::string_view script{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
-
-  const auto loader = lua.load(script, std::format("@{}", filename));
+  const auto loader = scriptcache::load(lua, std::format("scripts/{}.lua", module));
   verify(loader);
   return sol::make_object(lua, loader.get<sol::protected_function>());
 }
 
-class lua_loopable final : public loopable {
+class garbagecollector final : public lifecycleobserver {
 public:
-  explicit lua_loopable(const sol::state_view lua)
-      : _L(lua), _start(SDL_GetTicks()) {}
+  explicit garbagecollector(const sol::state_view lua)
+      : _L(lua),
+        _frequency(static_cast<double>(SDL_GetPerformanceFrequency())),
+        _budget(budget()),
+        _start(SDL_GetPerformanceCounter()),
+        _second(SDL_GetTicks()),
+        _baseline(lua_gc(_L, LUA_GCCOUNT, 0)) {}
+
+  void on_beginupdate() override {
+    _start = SDL_GetPerformanceCounter();
+  }
 
-  void loop(float delta) override {
-    _frames++;
-    const auto now = SDL_GetTicks();
-    _elapsed += now - _start;
-    _start = now;
+  void on_enddraw() override {
+    ++_frames;
 
     const auto memory = lua_gc(_L, LUA_GCCOUNT, 0);
+    const auto allocated = std::max(memory - _baseline, 0);
+    _rate = _rate * .9 + static_cast<double>(allocated) * .1;
+
+    const auto step = std::clamp(static_cast<int>(_rate * 2.0), 1, 1024);
+    const auto begin = SDL_GetPerformanceCounter();
+    const auto slack = _budget * .75 - static_cast<double>(begin - _start) / _frequency;
+
+    auto steps = 0;
+    if (slack > .0) {
+      const auto deadline = begin + static_cast<uint64_t>(slack * _frequency);
+      do {
+        ++steps;
+        if (lua_gc(_L, LUA_GCSTEP, step)) {
+          ++_cycles;
+          break;
+        }
+      } while (SDL_GetPerformanceCounter() < deadline);
+    }
+
+    const auto pause = static_cast<double>(SDL_GetPerformanceCounter() - begin) * 1000.0 / _frequency;
+    _last = pause;
+    _max = std::max(_max, pause);
+    _total += pause;
+    _steps += static_cast<uint64_t>(steps);
+    _baseline = lua_gc(_L, LUA_GCCOUNT, 0);
 
-    if (_elapsed >= 1000) [[unlikely]] {
-      std::println("{:.1f} {}KB", static_cast<double>(_frames) * 1000.0 / static_cast<double>(_elapsed), memory);
+    const auto now = SDL_GetTicks();
+    if (now - _second >= 1000) [[unlikely]] {
+      const auto elapsed = static_cast<double>(now - _second);
+      std::println("{:.1f} {}KB gc {:.2f}ms max {:.2f}ms", static_cast<double>(_frames) * 1000.0 / elapsed, _baseline, _total - _reported, _max);
 
-      _elapsed = 0;
+      _reported = _total;
+      _second = now;
       _frames = 0;
     }
+  }
 
-    if (memory <= 8192) [[likely]] {
-      lua_gc(_L, LUA_GCSTEP, 8);
-      return;
+  [[nodiscard]] int memory() const noexcept { return lua_gc(_L, LUA_GCCOUNT, 0); }
+  [[nodiscard]] double rate() const noexcept { return _rate; }
+  [[nodiscard]] double last() const noexcept { return _last; }
+  [[nodiscard]] double max() const noexcept { return _max; }
+  [[nodiscard]] double total() const noexcept { return _total; }
+  [[nodiscard]] uint64_t steps() const noexcept { return _steps; }
+  [[nodiscard]] uint64_t cycles() const noexcept { return _cycles; }
+
+  void reset() noexcept {
+    _max = .0;
+    _total = .0;
+    _reported = .0;
+    _steps = 0;
+    _cycles = 0;
+  }
+
+private:
+  static double budget() noexcept {
+    auto refresh = 60.0f;
+    if (auto* const window = SDL_GetRenderWindow(renderer)) {
+      if (const auto* const mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window)); mode && mode->refresh_rate > .0f) {
+        refresh = mode->refresh_rate;
+      }
     }
 
-    lua_gc(_L, LUA_GCCOLLECT, 0);
-    lua_gc(_L, LUA_GCCOLLECT, 0);
+    return 1.0 / static_cast<double>(refresh);
   }
 
-private:
   lua_State* _L;
-  uint64_t _frames{0};
-  uint64_t _elapsed{0};
+  double _frequency;
+  double _budget;
+  double _rate{.0};
+  double _last{.0};
+  double _max{.0};
+  double _total{.0};
+  double _reported{.0};
   uint64_t _start;
+  uint64_t _second;
+  uint64_t _frames{0};
+  uint64_t _steps{0};
+  uint64_t _cycles{0};
+  int _baseline;
 };
 
 struct sentinel final {
@@ -88,38 +149,129 @@ struct sentinel final {
 
 struct metaobject {
   static sol::object index(objectproxy& self, sol::stack_object key, sol::this_state state) {
-    sol::state_view lua{state};
     const auto name = key.as<std::string_view>();
 
-    if (auto* sc = self._registry.try_get<scriptable>(self._entity); sc && sc->module.valid()) {
-      const auto fname = std::format("on_{}", name);
-      if (auto fn = sc->module[fname].get<sol::protected_function>(); fn.valid()) {
-        return sol::make_object(lua, [fn](sol::variadic_args va) { return fn(va); });
+    if (!self.alive()) [[unlikely]] {
+      return sol::make_object(state, sol::lua_nil);
+    }
+
+    if (const auto* sc = self._registry->try_get<scriptable>(self._entity)) {
+      if (const auto it = sc->prototype->methods.find(name); it != sc->prototype->methods.end()) {
+        return it->second;
+      }
+    }
+
+    if (const auto* values = self.find_values()) {
+      if (const auto* value = values->find(name)) {
+        return value->value();
       }
     }
 
-    return self.kv.get(name)->value();
+    return sol::make_object(state, sol::lua_nil);
   }
 
   static void new_index(objectproxy& self, sol::stack_object key, sol::stack_object value) {
-    self.kv.set(key.as<std::string_view>(), value);
+    if (!self.alive()) [[unlikely]] {
+      return;
+    }
+
+    self.values().set(key.as<std::string_view>(), value);
   }
 };
 
-namespace {
-  constexpr auto DEADZONE = 8000;
+template <auto getter>
+auto living(const objectproxy& self) -> std::optional<std::remove_cvref_t<std::invoke_result_t<decltype(getter), const objectproxy&>>> {
+  if (!self.alive()) [[unlikely]] {
+    return std::nullopt;
+  }
 
-  int16_t deadzone(int16_t value) noexcept {
-    if (std::abs(value) < DEADZONE) {
-      return 0;
-    }
+  return std::invoke(getter, self);
+}
+
+static void wire(sol::state& lua, scene& scene) {
+  const auto name = scene.name();
+
+  const auto filename = std::format("scenes/{}.lua", name);
+  const auto result = scriptcache::load(lua, filename);
+  verify(result);
+
+  const auto pf = result.get<sol::protected_function>();
+  const auto exec = stopwatch::measure(stage::execute, filename, [&] { return pf(); });
+  verify(exec);
+
+  auto module = exec.get<sol::table>();
+  auto loaded = lua["package"]["loaded"];
+  loaded[std::format("scenes/{}", name)] = module;
+
+  if (auto fn = module["on_enter"].get<sol::protected_function>(); fn.valid()) {
+    auto* const ptr = &scene;
+    const auto wrapper = [fn, ptr, &lua, module]() {
+      auto pool = lua.create_table();
+
+      ptr->populate(pool);
+
+      lua["pool"] = pool;
+
+      const auto result = fn();
+      if (!result.valid()) {
+        sol::error err = result;
+        throw std::runtime_error(err.what());
+      }
+
+      if (auto onloop = module["on_loop"].get<sol::protected_function>(); onloop.valid()) {
+        ptr->set_onloop(std::move(onloop));
+      }
+
+      if (auto onmotion = module["on_motion"].get<sol::protected_function>(); onmotion.valid()) {
+        ptr->set_onmotion(std::move(onmotion));
+      }
+
+      if (auto oncamera = module["on_camera"].get<sol::protected_function>(); oncamera.valid()) {
+        ptr->set_oncamera(std::move(oncamera));
+      }
 
-    return value;
+      if (auto ontouch = module["on_touch"].get<sol::protected_function>(); ontouch.valid()) {
+        ptr->set_ontouch(std::move(ontouch));
+      }
+
+      if (auto onkeypress = module["on_keypress"].get<sol::protected_function>(); onkeypress.valid()) {
+        ptr->set_onkeypress(std::move(onkeypress));
+      }
+
+      if (auto onkeyrelease = module["on_keyrelease"].get<sol::protected_function>(); onkeyrelease.valid()) {
+        ptr->set_onkeyrelease(std::move(onkeyrelease));
+      }
+
+      if (auto ontick = module["on_tick"].get<sol::protected_function>(); ontick.valid()) {
+        ptr->set_ontick(std::move(ontick));
+      }
+
+      auto onleave = module["on_leave"].get<sol::protected_function>();
+      const auto wrapper = [onleave, &lua]() {
+        if (onleave.valid()) {
+          const auto result = onleave();
+          if (!result.valid()) {
+            sol::error err = result;
+            throw std::runtime_error(err.what());
+          }
+        }
+
+        lua["pool"] = sol::lua_nil;
+        lua["spawn"] = sol::lua_nil;
+        lua["async"] = sol::lua_nil;
+        lua["cancel"] = sol::lua_nil;
+      };
+
+      ptr->set_onleave(std::move(wrapper));
+    };
+
+    scene.set_onenter(std::move(wrapper));
   }
 }
 
 void scriptengine::run() {
   const auto start = SDL_GetPerformanceCounter();
+  stopwatch::begin();
 
   sol::state lua;
   lua.open_libraries();
@@ -158,6 +310,18 @@ void scriptengine::run() {
 
   lua["moment"] = []() noexcept { return SDL_GetTicks(); };
 
+  lua["wait"] = sol::yielding([](sol::this_state state, std::optional<uint64_t> ms) {
+    scheduler::sleep(state, ms.value_or(0));
+  });
+
+  lua["wait_ticks"] = sol::yielding([](sol::this_state state, std::optional<uint64_t> ticks) {
+    scheduler::sleep_ticks(state, ticks.value_or(1));
+  });
+
+  lua["wait_until_animation_end"] = sol::yielding([](sol::this_state state, const objectproxy& proxy) {
+    scheduler::await(state, proxy.entity());
+  });
+
   lua["openurl"] = [](std::string_view url) {
 #ifdef EMSCRIPTEN
     const auto script = std::format(R"javascript(window.open('{}', '_blank', 'noopener,noreferrer');)javascript", url);
@@ -249,10 +413,33 @@ void scriptengine::run() {
      },
      "stop", &soundfx::stop,
      "volume", sol::property(&soundfx::volume, &soundfx::set_volume),
+     "policy", sol::property(&soundfx::policy, &soundfx::set_policy),
      "on_begin", &soundfx::set_onbegin,
      "on_end", &soundfx::set_onend
   );
 
+  lua.new_enum(
+    "VoicePolicy",
+    "oldest", voicepolicy::oldest,
+    "quietest", voicepolicy::quietest
+  );
+
+  lua.new_enum(
+    "Easing",
+    "linear", easing::linear,
+    "quadin", easing::quadin,
+    "quadout", easing::quadout,
+    "quadinout", easing::quadinout,
+    "cubicin", easing::cubicin,
+    "cubicout", easing::cubicout,
+    "cubicinout", easing::cubicinout,
+    "sinein", easing::sinein,
+    "sineout", easing::sineout,
+    "sineinout", easing::sineinout,
+    "backout", easing::backout,
+    "bounceout", easing::bounceout
+  );
+
   lua.new_enum(
     "Flip",
     "none", flip::none,
@@ -318,18 +505,18 @@ void scriptengine::run() {
     "Entity",
     sol::no_constructor,
     "id", sol::property(&objectproxy::id),
-    "x", sol::property(&objectproxy::x, &objectproxy::set_x),
-    "y", sol::property(&objectproxy::y, &objectproxy::set_y),
-    "z", sol::property(&objectproxy::z, &objectproxy::set_z),
-    "alpha", sol::property(&objectproxy::alpha, &objectproxy::set_alpha),
-    "angle", sol::property(&objectproxy::angle, &objectproxy::set_angle),
-    "scale", sol::property(&objectproxy::scale, &objectproxy::set_scale),
-    "flip", sol::property(&objectproxy::flip, &objectproxy::set_flip),
-    "visible", sol::property(&objectproxy::visible, &objectproxy::set_visible),
-    "action", sol::property(&objectproxy::action, &objectproxy::set_action),
-    "kind", sol::property(&objectproxy::kind, &objectproxy::set_kind),
+    "x", sol::property(&living<&objectproxy::x>, &objectproxy::set_x),
+    "y", sol::property(&living<&objectproxy::y>, &objectproxy::set_y),
+    "z", sol::property(&living<&objectproxy::z>, &objectproxy::set_z),
+    "alpha", sol::property(&living<&objectproxy::alpha>, &objectproxy::set_alpha),
+    "angle", sol::property(&living<&objectproxy::angle>, &objectproxy::set_angle),
+    "scale", sol::property(&living<&objectproxy::scale>, &objectproxy::set_scale),
+    "flip", sol::property(&living<&objectproxy::flip>, &objectproxy::set_flip),
+    "visible", sol::property(&living<&objectproxy::visible>, &objectproxy::set_visible),
+    "action", sol::property(&living<&objectproxy::action>, &objectproxy::set_action),
+    "kind", sol::property(&living<&objectproxy::kind>, &objectproxy::set_kind),
     "position", sol::property(
-      &objectproxy::position,
+      &living<&objectproxy::position>,
       [](objectproxy& self, sol::table table) {
         const auto x = table.get_or("x", table.get_or(1, .0f));
         const auto y = table.get_or("y", table.get_or(2, .0f));
@@ -337,7 +524,7 @@ void scriptengine::run() {
       }
     ),
     "velocity", sol::property(
-      &objectproxy::velocity,
+      &living<&objectproxy::velocity>,
       [](objectproxy& self, sol::table table) {
         const auto x = table.get_or("x", table.get_or(1, .0f));
         const auto y = table.get_or("y", table.get_or(2, .0f));
@@ -356,17 +543,66 @@ void scriptengine::run() {
     "on_screen_enter", &objectproxy::set_onscreenenter,
     "on_appear", &objectproxy::set_onappear,
     "on_disappear", &objectproxy::set_ondisappear,
-    "clone", &objectproxy::clone,
+    "tween", [](objectproxy& self, sol::table properties, uint64_t duration, std::optional<easing> curve, sol::optional<sol::protected_function> on_complete) {
+      static const boost::unordered_flat_map<std::string_view, tweenable::property> names{
+        {"x", tweenable::property::x},
+        {"y", tweenable::property::y},
+        {"alpha", tweenable::property::alpha},
+        {"scale", tweenable::property::scale},
+        {"angle", tweenable::property::angle},
+      };
+
+      boost::container::small_vector<tweenable::track, 4> tracks;
+      properties.for_each([&](const sol::object& key, const sol::object& value) {
+        const auto name = key.as<std::string_view>();
+        if (name == "position") {
+          const auto table = value.as<sol::table>();
+          tracks.push_back({tweenable::property::x, 0, table.get_or("x", table.get_or(1, .0f))});
+          tracks.push_back({tweenable::property::y, 0, table.get_or("y", table.get_or(2, .0f))});
+          return;
+        }
+
+        const auto it = names.find(name);
+        if (it == names.end()) [[unlikely]] {
+          throw std::runtime_error(std::format("[tween] unknown property '{}'", name));
+        }
+
+        tracks.push_back({it->second, 0, value.as<float>()});
+      });
+
+      self.tween({tracks.data(), tracks.size()}, duration, curve.value_or(easing::linear), on_complete.value_or(sol::protected_function{}));
+      return self;
+    },
+    "untween", &objectproxy::untween,
+    "clone", [](objectproxy& self) -> std::optional<objectproxy> {
+      if (!self.alive()) [[unlikely]] {
+        return std::nullopt;
+      }
+
+      return self.clone();
+    },
     "alive", sol::property(&objectproxy::alive),
     "die", &objectproxy::die,
-    "observable", [](objectproxy& self, std::string_view name) {
-      return self.kv.get(name);
+    "observable", [](objectproxy& self, std::string_view name) -> std::shared_ptr<observable> {
+      if (!self.alive()) [[unlikely]] {
+        return nullptr;
+      }
+
+      return self.values().get(name);
     },
     "subscribe", [](objectproxy& self, std::string_view name, sol::protected_function fn) -> uint32_t {
-      return self.kv.get(name)->subscribe(std::move(fn));
+      if (!self.alive()) [[unlikely]] {
+        return 0;
+      }
+
+      return self.values().get(name)->subscribe(std::move(fn));
     },
     "unsubscribe", [](objectproxy& self, std::string_view name, uint32_t id) {
-      self.kv.get(name)->unsubscribe(id);
+      if (!self.alive()) [[unlikely]] {
+        return;
+      }
+
+      self.values().get(name)->unsubscribe(id);
     },
     sol::meta_function::index, metaobject::index,
     sol::meta_function::new_index, metaobject::new_index
@@ -401,100 +637,36 @@ void scriptengine::run() {
       std::string_view name
     ) {
       const auto start = SDL_GetPerformanceCounter();
+      stopwatch::begin();
 
       try {
-        const auto scene = self.load(name);
+        const auto scene = self.load(name, [&lua](::scene& scene) { wire(lua, scene); });
         if (!scene) [[unlikely]] {
+          stopwatch::end();
           return;
         }
 
-        const auto filename = std::format("scenes/{}.lua", name);
-        const auto buffer = io::read(filename);
-        std::string_view script{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
-
-        const auto result = lua.load(script, std::format("@{}", filename));
-        verify(result);
-
-        const auto pf = result.get<sol::protected_function>();
-        const auto exec = pf();
-        verify(exec);
-
-        auto module = exec.get<sol::table>();
-        auto loaded = lua["package"]["loaded"];
-        loaded[std::format("scenes/{}", name)] = module;
-
-        if (auto fn = module["on_enter"].get<sol::protected_function>(); fn.valid()) {
-          auto* const ptr = scene.get();
-          const auto wrapper = [fn, ptr, &lua, module]() {
-            auto pool = lua.create_table();
-
-            ptr->populate(pool);
-
-            lua["pool"] = pool;
-
-            const auto result = fn();
-            if (!result.valid()) {
-              sol::error err = result;
-              throw std::runtime_error(err.what());
-            }
-
-            if (auto onloop = module["on_loop"].get<sol::protected_function>(); onloop.valid()) {
-              ptr->set_onloop(std::move(onloop));
-            }
-
-            if (auto onmotion = module["on_motion"].get<sol::protected_function>(); onmotion.valid()) {
-              ptr->set_onmotion(std::move(onmotion));
-            }
-
-            if (auto oncamera = module["on_camera"].get<sol::protected_function>(); oncamera.valid()) {
-              ptr->set_oncamera(std::move(oncamera));
-            }
-
-            if (auto ontouch = module["on_touch"].get<sol::protected_function>(); ontouch.valid()) {
-              ptr->set_ontouch(std::move(ontouch));
-            }
-
-            if (auto onkeypress = module["on_keypress"].get<sol::protected_function>(); onkeypress.valid()) {
-              ptr->set_onkeypress(std::move(onkeypress));
-            }
-
-            if (auto onkeyrelease = module["on_keyrelease"].get<sol::protected_function>(); onkeyrelease.valid()) {
-              ptr->set_onkeyrelease(std::move(onkeyrelease));
-            }
-
-            if (auto ontick = module["on_tick"].get<sol::protected_function>(); ontick.valid()) {
-              ptr->set_ontick(std::move(ontick));
-            }
-
-            auto onleave = module["on_leave"].get<sol::protected_function>();
-            const auto wrapper = [onleave, &lua]() {
-              if (onleave.valid()) {
-                const auto result = onleave();
-                if (!result.valid()) {
-                  sol::error err = result;
-                  throw std::runtime_error(err.what());
-                }
-              }
-
-              lua["pool"] = sol::lua_nil;
-            };
-
-            ptr->set_onleave(std::move(wrapper));
-          };
-
-          scene->set_onenter(std::move(wrapper));
-
-          lua.collect_garbage();
-          lua.collect_garbage();
-        }
-
         const auto end = SDL_GetPerformanceCounter();
         const auto elapsed = static_cast<double>(end - start) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
-        std::println("[scriptengine] {} took {:.3f}ms", name, elapsed);
+        stopwatch::report(name, elapsed);
+        stopwatch::end();
+      } catch (const std::exception& e) {
+        stopwatch::end();
+        luaL_error(lua, e.what());
+      }
+    },
+    "preload", [&lua](
+      scenemanager& self,
+      std::string_view name
+    ) {
+      try {
+        self.preload(name, [&lua](::scene& scene) { wire(lua, scene); });
       } catch (const std::exception& e) {
         luaL_error(lua, e.what());
       }
-    });
+    },
+    "progress", &scenemanager::progress
+  );
 
   lua.new_usertype<cursor>(
     "Cursor",
@@ -542,7 +714,7 @@ void scriptengine::run() {
     "clear", &particlepool::clear
   );
 
-  lua["cassette"] = cassette();
+  lua["cassette"] = std::make_shared<cassette>();
 
   lua.new_usertype<enginefactory>(
     "EngineFactory",
@@ -555,6 +727,12 @@ void scriptengine::run() {
     "with_fullscreen", &enginefactory::with_fullscreen,
     "with_sentry", &enginefactory::with_sentry,
     "with_ticks", &enginefactory::with_ticks,
+    "with_cache", &enginefactory::with_cache,
+    "with_texturebudget", &enginefactory::with_texturebudget,
+    "with_cliplength", &enginefactory::with_cliplength,
+    "with_polyphony", &enginefactory::with_polyphony,
+    "with_voicelimit", &enginefactory::with_voicelimit,
+    "with_actions", &enginefactory::with_actions,
     "create", [](enginefactory& self, sol::this_state state) {
       sol::state_view lua{state};
       auto ptr = self.create();
@@ -807,167 +985,127 @@ void scriptengine::run() {
   );
 
   struct keyboard final {
-    static auto index(const keyboard&, sol::stack_object key, sol::this_state state) {
-      static const boost::unordered_flat_map<std::string_view, SDL_Scancode> mapping{
-        {"a", SDL_SCANCODE_A}, {"b", SDL_SCANCODE_B}, {"c", SDL_SCANCODE_C}, {"d", SDL_SCANCODE_D},
-        {"e", SDL_SCANCODE_E}, {"f", SDL_SCANCODE_F}, {"g", SDL_SCANCODE_G}, {"h", SDL_SCANCODE_H},
-        {"i", SDL_SCANCODE_I}, {"j", SDL_SCANCODE_J}, {"k", SDL_SCANCODE_K}, {"l", SDL_SCANCODE_L},
-        {"m", SDL_SCANCODE_M}, {"n", SDL_SCANCODE_N}, {"o", SDL_SCANCODE_O}, {"p", SDL_SCANCODE_P},
-        {"q", SDL_SCANCODE_Q}, {"r", SDL_SCANCODE_R}, {"s", SDL_SCANCODE_S}, {"t", SDL_SCANCODE_T},
-        {"u", SDL_SCANCODE_U}, {"v", SDL_SCANCODE_V}, {"w", SDL_SCANCODE_W}, {"x", SDL_SCANCODE_X},
-        {"y", SDL_SCANCODE_Y}, {"z", SDL_SCANCODE_Z},
-
-        {"0", SDL_SCANCODE_0}, {"1", SDL_SCANCODE_1}, {"2", SDL_SCANCODE_2}, {"3", SDL_SCANCODE_3},
-        {"4", SDL_SCANCODE_4}, {"5", SDL_SCANCODE_5}, {"6", SDL_SCANCODE_6}, {"7", SDL_SCANCODE_7},
-        {"8", SDL_SCANCODE_8}, {"9", SDL_SCANCODE_9},
-
-        {"up", SDL_SCANCODE_UP}, {"down", SDL_SCANCODE_DOWN},
-        {"left", SDL_SCANCODE_LEFT}, {"right", SDL_SCANCODE_RIGHT},
-
-        {"shift", SDL_SCANCODE_LSHIFT}, {"ctrl", SDL_SCANCODE_LCTRL},
-
-        {"escape", SDL_SCANCODE_ESCAPE}, {"space", SDL_SCANCODE_SPACE},
-        {"enter", SDL_SCANCODE_RETURN}, {"backspace", SDL_SCANCODE_BACKSPACE},
-        {"tab", SDL_SCANCODE_TAB}
-      };
+    static int scancode(int code) noexcept {
+      if (code >= KEY_HANDLE) [[likely]] {
+        return code - KEY_HANDLE;
+      }
+
+      if (code < 0 || code > 9) [[unlikely]] {
+        return SDL_SCANCODE_UNKNOWN;
+      }
 
+      const auto digit = static_cast<char>('0' + code);
+      return input::keys().find(std::string_view(&digit, 1))->second;
+    }
+
+    static auto index(const keyboard&, sol::stack_object key, sol::this_state state) {
       sol::state_view lua{state};
-      const auto it = mapping.find(key.as<std::string_view>());
-      if (it == mapping.end()) [[unlikely]] {
+      if (key.get_type() == sol::type::number) [[likely]] {
+        return sol::make_object(lua, input::down(scancode(key.as<int>())));
+      }
+
+      const auto& keys = input::keys();
+      const auto it = keys.find(key.as<std::string_view>());
+      if (it == keys.end()) [[unlikely]] {
         return sol::make_object(lua, sol::lua_nil);
       }
 
-      return sol::make_object(lua, SDL_GetKeyboardState(nullptr)[it->second]);
+      return sol::make_object(lua, input::down(it->second));
     }
   };
 
+  auto keytable = lua.create_named_table("Key");
+  for (const auto& [name, code] : input::keys()) {
+    keytable[name] = code + KEY_HANDLE;
+  }
+
+  auto buttontable = lua.create_named_table("GamepadButton");
+  for (const auto& [name, button] : input::buttons()) {
+    buttontable[name] = button;
+  }
+
   lua.new_usertype<keyboard>(
     "Keyboard",
     sol::no_constructor,
+    "pressed", [](const keyboard&, int code) noexcept { return input::pressed(keyboard::scancode(code)); },
+    "released", [](const keyboard&, int code) noexcept { return input::released(keyboard::scancode(code)); },
     sol::meta_function::index, &keyboard::index
   );
 
   lua["keyboard"] = keyboard{};
 
   struct gamepadslot final {
-    int slot;
-    std::unique_ptr<SDL_Gamepad, SDL_Deleter> gamepad{nullptr};
+    size_t slot;
 
-    static auto index(gamepadslot& self, sol::stack_object key, sol::this_state state) {
+    static auto index(const gamepadslot& self, sol::stack_object key, sol::this_state state) {
       sol::state_view lua{state};
+      const auto& pad = input::pad(self.slot);
+
+      if (key.get_type() == sol::type::number) [[likely]] {
+        const auto button = key.as<int>();
+        return sol::make_object(lua, button >= 0 && button < SDL_GAMEPAD_BUTTON_COUNT && pad.down[static_cast<size_t>(button)]);
+      }
+
       const auto name = key.as<std::string_view>();
+      const auto axis = [&pad](SDL_GamepadAxis which) noexcept {
+        return input::deadzone(pad.axes[static_cast<size_t>(which)]);
+      };
 
       if (name == "connected") {
-        return sol::make_object(lua, self.valid());
+        return sol::make_object(lua, pad.connected);
       }
 
       if (name == "name") {
-        if (self.valid()) [[likely]] {
-          return sol::make_object(lua, SDL_GetGamepadName(self.gamepad.get()));
+        if (pad.name) [[likely]] {
+          return sol::make_object(lua, pad.name);
         }
 
         return sol::make_object(lua, sol::lua_nil);
       }
 
       if (name == "leftstick") {
-        const auto x = SDL_GetGamepadAxis(self.gamepad.get(), SDL_GAMEPAD_AXIS_LEFTX);
-        const auto y = SDL_GetGamepadAxis(self.gamepad.get(), SDL_GAMEPAD_AXIS_LEFTY);
-
-        return sol::make_object(lua, std::make_pair(deadzone(x), deadzone(y)));
+        return sol::make_object(lua, std::make_pair(axis(SDL_GAMEPAD_AXIS_LEFTX), axis(SDL_GAMEPAD_AXIS_LEFTY)));
       }
 
       if (name == "rightstick") {
-        const auto x = SDL_GetGamepadAxis(self.gamepad.get(), SDL_GAMEPAD_AXIS_RIGHTX);
-        const auto y = SDL_GetGamepadAxis(self.gamepad.get(), SDL_GAMEPAD_AXIS_RIGHTY);
-
-        return sol::make_object(lua, std::make_pair(deadzone(x), deadzone(y)));
+        return sol::make_object(lua, std::make_pair(axis(SDL_GAMEPAD_AXIS_RIGHTX), axis(SDL_GAMEPAD_AXIS_RIGHTY)));
       }
 
       if (name == "triggers") {
-        const auto left = SDL_GetGamepadAxis(self.gamepad.get(), SDL_GAMEPAD_AXIS_LEFT_TRIGGER);
-        const auto right = SDL_GetGamepadAxis(self.gamepad.get(), SDL_GAMEPAD_AXIS_RIGHT_TRIGGER);
-
-        return sol::make_object(lua, std::make_pair(deadzone(left), deadzone(right)));
+        return sol::make_object(lua, std::make_pair(axis(SDL_GAMEPAD_AXIS_LEFT_TRIGGER), axis(SDL_GAMEPAD_AXIS_RIGHT_TRIGGER)));
       }
 
-      {
-        static const boost::unordered_flat_map<std::string_view, SDL_GamepadButton> mapping{
-          {"south", SDL_GAMEPAD_BUTTON_SOUTH}, {"east", SDL_GAMEPAD_BUTTON_EAST},
-          {"west", SDL_GAMEPAD_BUTTON_WEST}, {"north", SDL_GAMEPAD_BUTTON_NORTH},
-          {"back", SDL_GAMEPAD_BUTTON_BACK}, {"guide", SDL_GAMEPAD_BUTTON_GUIDE},
-          {"start", SDL_GAMEPAD_BUTTON_START}, {"leftstick", SDL_GAMEPAD_BUTTON_LEFT_STICK},
-          {"rightstick", SDL_GAMEPAD_BUTTON_RIGHT_STICK}, {"leftshoulder", SDL_GAMEPAD_BUTTON_LEFT_SHOULDER},
-          {"rightshoulder", SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER}, {"up", SDL_GAMEPAD_BUTTON_DPAD_UP},
-          {"down", SDL_GAMEPAD_BUTTON_DPAD_DOWN}, {"left", SDL_GAMEPAD_BUTTON_DPAD_LEFT},
-          {"right", SDL_GAMEPAD_BUTTON_DPAD_RIGHT}
-        };
-
-        const auto it = mapping.find(name);
-        if (it != mapping.end()) [[likely]] {
-          if (self.valid()) [[likely]] {
-            return sol::make_object(lua, SDL_GetGamepadButton(self.gamepad.get(), it->second));
-          }
-          return sol::make_object(lua, false);
-        }
+      if (const auto it = input::buttons().find(name); it != input::buttons().end()) [[likely]] {
+        return sol::make_object(lua, static_cast<bool>(pad.down[static_cast<size_t>(it->second)]));
       }
 
-      {
-        static const boost::unordered_flat_map<std::string_view, SDL_GamepadAxis> mapping{
-          {"leftx", SDL_GAMEPAD_AXIS_LEFTX}, {"lefty", SDL_GAMEPAD_AXIS_LEFTY},
-          {"rightx", SDL_GAMEPAD_AXIS_RIGHTX}, {"righty", SDL_GAMEPAD_AXIS_RIGHTY},
-          {"triggerleft", SDL_GAMEPAD_AXIS_LEFT_TRIGGER}, {"triggerright", SDL_GAMEPAD_AXIS_RIGHT_TRIGGER}
-        };
-
-        const auto it = mapping.find(name);
-        if (it != mapping.end()) {
-          if (self.valid()) [[likely]] {
-            const auto value = SDL_GetGamepadAxis(self.gamepad.get(), it->second);
-            return sol::make_object(lua, deadzone(value));
-          }
-
-          return sol::make_object(lua, 0);
-        }
+      if (const auto it = input::axes().find(name); it != input::axes().end()) {
+        return sol::make_object(lua, axis(static_cast<SDL_GamepadAxis>(it->second)));
       }
 
       return sol::make_object(lua, sol::lua_nil);
     }
 
-    [[nodiscard]] bool valid() noexcept {
-      if (gamepad) [[likely]] {
-        if (SDL_GamepadConnected(gamepad.get())) [[likely]] {
-          return true;
-        }
-
-        gamepad.reset();
-      }
-
-      if (!SDL_HasGamepad()) {
-        return false;
-      }
-
-      auto count = 0;
-      const auto gamepads = std::unique_ptr<SDL_JoystickID[], SDL_Deleter>(SDL_GetGamepads(&count));
-      if (gamepads && slot < count) [[likely]] {
-        gamepad.reset(SDL_OpenGamepad(gamepads[static_cast<size_t>(slot)]));
-      }
+    [[nodiscard]] bool pressed(int button) const noexcept {
+      return button >= 0 && button < SDL_GAMEPAD_BUTTON_COUNT && input::pad(slot).pressed[static_cast<size_t>(button)];
+    }
 
-      return gamepad != nullptr;
+    [[nodiscard]] bool released(int button) const noexcept {
+      return button >= 0 && button < SDL_GAMEPAD_BUTTON_COUNT && input::pad(slot).released[static_cast<size_t>(button)];
     }
   };
 
-  std::array<gamepadslot, 4> gamepadslots{gamepadslot{0}, gamepadslot{1}, gamepadslot{2}, gamepadslot{3}};
-
   struct gamepads final {
     [[nodiscard]] static int count() noexcept {
-      auto total = 0;
-      SDL_GetGamepads(&total);
-      return std::min(total, 4);
+      return input::count();
     }
   };
 
   lua.new_usertype<gamepadslot>(
     "GamepadSlot",
     sol::no_constructor,
+    "pressed", &gamepadslot::pressed,
+    "released", &gamepadslot::released,
     sol::meta_function::index, &gamepadslot::index
   );
 
@@ -975,13 +1113,41 @@ void scriptengine::run() {
     "Gamepads",
     sol::no_constructor,
     "count", sol::property(&gamepads::count),
-    sol::meta_function::index, [&gamepadslots](gamepads&, int slot) noexcept -> gamepadslot& {
-      return gamepadslots[static_cast<size_t>(std::clamp(slot, 0, 3))];
+    sol::meta_function::index, [](gamepads&, int slot) noexcept {
+      return gamepadslot{static_cast<size_t>(std::clamp(slot, 0, static_cast<int>(input::slots) - 1))};
     }
   );
 
   lua["gamepads"] = gamepads{};
 
+  lua.new_usertype<action>(
+    "Action",
+    sol::no_constructor,
+    "down", sol::readonly(&action::down),
+    "pressed", sol::readonly(&action::pressed),
+    "released", sol::readonly(&action::released),
+    "buffered", sol::readonly(&action::buffered),
+    "value", sol::readonly(&action::value),
+    "since", sol::readonly(&action::since),
+    "frame", sol::readonly(&action::frame),
+    "consume", &action::consume
+  );
+
+  struct actions final {
+    static action* index(const actions&, std::string_view name) noexcept {
+      return actionmap::find(name);
+    }
+  };
+
+  lua.new_usertype<actions>(
+    "Actions",
+    sol::no_constructor,
+    "frame", sol::property([](const actions&) noexcept { return actionmap::frame(); }),
+    sol::meta_function::index, &actions::index
+  );
+
+  lua["actions"] = actions{};
+
   lua.new_enum(
     "Player",
     "one", 0,
@@ -1070,22 +1236,39 @@ void scriptengine::run() {
   lua.script(bootstrap, "@bootstrap");
   lua.script(debugger, "@debugger");
 
-  const auto buffer = io::read("scripts/main.lua");
-  std::string_view script{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
-  const auto source = lua.safe_script(script, "@main.lua");
+  const auto main = scriptcache::load(lua, "scripts/main.lua");
+  verify(main);
+
+  const auto source = stopwatch::measure(stage::execute, "scripts/main.lua", [&] { return main.get<sol::protected_function>()(); });
   verify(source);
 
   const auto engine = lua["engine"].get<std::shared_ptr<::engine>>();
 
   const auto setup = lua["setup"].get<sol::protected_function>();
-  const auto result = setup();
+  const auto result = stopwatch::measure(stage::execute, "setup", [&] { return setup(); });
   verify(result);
-  engine->add_loopable(std::make_shared<lua_loopable>(lua));
+
+  const auto collector = std::make_shared<garbagecollector>(lua);
+  lua.new_usertype<garbagecollector>(
+    "GarbageCollector",
+    sol::no_constructor,
+    "memory", sol::property(&garbagecollector::memory),
+    "rate", sol::property(&garbagecollector::rate),
+    "last", sol::property(&garbagecollector::last),
+    "max", sol::property(&garbagecollector::max),
+    "total", sol::property(&garbagecollector::total),
+    "steps", sol::property(&garbagecollector::steps),
+    "cycles", sol::property(&garbagecollector::cycles),
+    "reset", &garbagecollector::reset
+  );
+  lua["garbagecollector"] = collector;
+  engine->add_observer(collector);
 
   const auto end = SDL_GetPerformanceCounter();
   const auto elapsed =
       (static_cast<double>(end - start) * 1000.0) / static_cast<double>(SDL_GetPerformanceFrequency());
-  std::println("boot time {:.3f}ms", elapsed);
+  stopwatch::report("boot", elapsed);
+  stopwatch::end();
 
   engine->run();
 }
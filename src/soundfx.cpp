@@ -1,89 +1,239 @@
 #include "soundfx.hpp"
 
+#include "assetmanager.hpp"
 #include "helper.hpp"
+#include "io.hpp"
+#include "stopwatch.hpp"
 
 #include <opusfile.h>
 
 namespace {
-  ma_result read(ma_data_source* source, void* output, ma_uint64 frames, ma_uint64* count) {
-    auto* self = reinterpret_cast<soundfx::stream*>(source);
-    const int channels = op_channel_count(self->file, -1);
+  constexpr auto SAMPLE_RATE = 48000u;
 
-    ma_uint64 total = 0;
-    while (total < frames) {
-      const auto remaining = frames - total;
-      const auto request = static_cast<int>(std::min<ma_uint64>(
-        remaining * static_cast<ma_uint64>(channels),
-        static_cast<ma_uint64>(std::numeric_limits<int>::max())
-      ));
+  uint64_t cliplength{SAMPLE_RATE * 3};
+  uint8_t polyphony{4};
+  uint32_t voicelimit{32};
+  uint64_t sequence{0};
+
+  std::vector<soundfx::voice*> voices;
+
+  constexpr auto ENVELOPE_FRAMES = 1024u;
+
+  bool busy(const soundfx::voice& v) noexcept {
+    return ma_sound_is_playing(&v.sound) && !ma_sound_at_end(&v.sound);
+  }
+
+  float level(const soundfx::voice& v) noexcept {
+    const auto gain = ma_sound_get_volume(&v.sound);
+    if (!v.clip || v.clip->envelope.empty()) [[unlikely]] {
+      return gain;
+    }
+
+    ma_uint64 cursor = 0;
+    ma_sound_get_cursor_in_pcm_frames(const_cast<ma_sound*>(&v.sound), &cursor);
+    const auto block = std::min<size_t>(static_cast<size_t>(cursor / ENVELOPE_FRAMES), v.clip->envelope.size() - 1);
+    return gain * static_cast<float>(v.clip->envelope[block]) / 32768.0f;
+  }
+
+  bool preferable(const soundfx::voice& lhs, const soundfx::voice& rhs, voicepolicy policy) noexcept {
+    if (policy == voicepolicy::quietest) {
+      const auto a = level(lhs);
+      const auto b = level(rhs);
+      if (a != b) {
+        return a < b;
+      }
+    }
+
+    return lhs.started < rhs.started;
+  }
 
-      auto* destination = static_cast<float*>(output) + total * static_cast<ma_uint64>(channels);
-      const int decoded = op_read_float(self->file, destination, request, nullptr);
+  constexpr auto RING_FRAMES = SAMPLE_RATE / 2;
+
+  constexpr auto DECODE_INTERVAL = std::chrono::milliseconds(5);
+
+  void fill(soundfx::stream& s) noexcept {
+    if (const auto epoch = s.epoch.load(std::memory_order_acquire); epoch != s.acknowledged.load(std::memory_order_relaxed)) {
+      op_pcm_seek(s.file, static_cast<ogg_int64_t>(s.target.load(std::memory_order_relaxed)));
+      s.eof.store(false, std::memory_order_relaxed);
+      s.stale.store(s.committed, std::memory_order_relaxed);
+      s.acknowledged.store(epoch, std::memory_order_release);
+    }
+
+    while (!s.eof.load(std::memory_order_relaxed)) {
+      auto frames = ma_pcm_rb_available_write(&s.ring);
+      if (frames == 0) {
+        return;
+      }
+
+      void* buffer;
+      ma_pcm_rb_acquire_write(&s.ring, &frames, &buffer);
+
+      const int decoded = op_read_float(s.file, static_cast<float*>(buffer), static_cast<int>(frames * s.channels), nullptr);
       if (decoded == OP_HOLE) [[unlikely]] {
+        ma_pcm_rb_commit_write(&s.ring, 0);
         continue;
       }
 
-      if (decoded < 0) [[unlikely]] {
-        if (count) [[likely]] {
-          *count = total;
+      if (decoded <= 0) [[unlikely]] {
+        ma_pcm_rb_commit_write(&s.ring, 0);
+
+        if (decoded == 0 && s.looping.load(std::memory_order_relaxed) && op_pcm_seek(s.file, 0) == 0) {
+          continue;
         }
 
-        return MA_ERROR;
+        s.eof.store(true, std::memory_order_release);
+        return;
       }
 
-      if (decoded == 0) [[unlikely]] {
-        break;
-      }
+      ma_pcm_rb_commit_write(&s.ring, static_cast<ma_uint32>(decoded));
+      s.committed += static_cast<uint64_t>(decoded);
+    }
+  }
+
+#ifndef EMSCRIPTEN
+  class decoder final {
+  public:
+    decoder()
+        : _thread([this](std::stop_token token) { run(token); }) {}
+
+    void add(soundfx::stream* s) {
+      std::lock_guard lock(_mutex);
+      _streams.emplace_back(s);
+    }
+
+    void remove(soundfx::stream* s) {
+      std::lock_guard lock(_mutex);
+      std::erase(_streams, s);
+    }
+
+  private:
+    void run(std::stop_token token) {
+      while (!token.stop_requested()) {
+        {
+          std::lock_guard lock(_mutex);
+          for (auto* const s : _streams) {
+            fill(*s);
+          }
+        }
 
-      total += static_cast<ma_uint64>(decoded);
+        std::this_thread::sleep_for(DECODE_INTERVAL);
+      }
     }
 
+    std::mutex _mutex;
+    std::vector<soundfx::stream*> _streams;
+    std::jthread _thread;
+  };
+
+  decoder& decoders() {
+    static decoder instance;
+    return instance;
+  }
+#endif
+
+  void silence(float* output, uint32_t channels, ma_uint64 frames) noexcept {
+    std::fill_n(output, frames * channels, .0f);
+  }
+
+  ma_result read(ma_data_source* source, void* output, ma_uint64 frames, ma_uint64* count) {
+    auto* self = reinterpret_cast<soundfx::stream*>(source);
+    auto* const destination = static_cast<float*>(output);
+
+#ifdef EMSCRIPTEN
+    fill(*self);
+#endif
+
     if (count) [[likely]] {
-      *count = total;
+      *count = frames;
     }
 
-    if (total == 0) [[unlikely]] {
-      return MA_AT_END;
+    if (self->acknowledged.load(std::memory_order_acquire) != self->epoch.load(std::memory_order_relaxed)) [[unlikely]] {
+      silence(destination, self->channels, frames);
+      return MA_SUCCESS;
+    }
+
+    const auto stale = self->stale.load(std::memory_order_relaxed);
+    while (self->consumed < stale) {
+      auto available = static_cast<ma_uint32>(std::min<uint64_t>(stale - self->consumed, ma_pcm_rb_available_read(&self->ring)));
+      if (available == 0) {
+        silence(destination, self->channels, frames);
+        return MA_SUCCESS;
+      }
+
+      void* buffer;
+      ma_pcm_rb_acquire_read(&self->ring, &available, &buffer);
+      ma_pcm_rb_commit_read(&self->ring, available);
+      self->consumed += available;
     }
 
-    if (total < frames) [[unlikely]] {
+    ma_uint64 total = 0;
+    while (total < frames) {
+      auto available = static_cast<ma_uint32>(std::min<ma_uint64>(frames - total, std::numeric_limits<ma_uint32>::max()));
+
+      void* buffer;
+      ma_pcm_rb_acquire_read(&self->ring, &available, &buffer);
+      if (available == 0) {
+        break;
+      }
+
+      std::memcpy(destination + total * self->channels, buffer, available * self->channels * sizeof(float));
+      ma_pcm_rb_commit_read(&self->ring, available);
+      total += available;
+    }
+
+    self->consumed += total;
+    self->position.fetch_add(total, std::memory_order_relaxed);
+
+    if (total == frames) [[likely]] {
+      return MA_SUCCESS;
+    }
+
+    if (self->eof.load(std::memory_order_acquire) && ma_pcm_rb_available_read(&self->ring) == 0) {
+      if (count) [[likely]] {
+        *count = total;
+      }
+
       return MA_AT_END;
     }
 
+    stopwatch::count(counter::underrun);
+    silence(destination + total * self->channels, self->channels, frames - total);
     return MA_SUCCESS;
   }
 
   ma_result seek(ma_data_source* source, ma_uint64 index) {
     auto* self = reinterpret_cast<soundfx::stream*>(source);
-    const int result = op_pcm_seek(self->file, static_cast<ogg_int64_t>(index));
-    if (result == 0) [[likely]] {
-      return MA_SUCCESS;
+    if (self->length != 0 && index > self->length) [[unlikely]] {
+      return MA_INVALID_ARGS;
     }
 
-    if (result == OP_ENOSEEK) [[unlikely]] {
-      return MA_INVALID_OPERATION;
+    const auto settled = self->acknowledged.load(std::memory_order_acquire) == self->epoch.load(std::memory_order_relaxed) && self->consumed >= self->stale.load(std::memory_order_relaxed);
+    if (settled && self->position.load(std::memory_order_relaxed) == index) {
+      return MA_SUCCESS;
     }
 
-    return MA_ERROR;
+    self->target.store(index, std::memory_order_relaxed);
+    self->position.store(index, std::memory_order_relaxed);
+    self->epoch.fetch_add(1, std::memory_order_release);
+    return MA_SUCCESS;
   }
 
   ma_result format(ma_data_source* source, ma_format* format, ma_uint32* channels, ma_uint32* rate, ma_channel* map, size_t capacity) {
     auto* self = reinterpret_cast<soundfx::stream*>(source);
-    const auto count = static_cast<ma_uint32>(op_channel_count(self->file, -1));
     if (format) {
       *format = ma_format_f32;
     }
 
     if (channels) {
-      *channels = count;
+      *channels = self->channels;
     }
 
     if (rate) {
-      *rate = 48000;
+      *rate = SAMPLE_RATE;
     }
 
     if (map) {
-      ma_channel_map_init_standard(ma_standard_channel_map_vorbis, map, capacity, count);
+      ma_channel_map_init_standard(ma_standard_channel_map_vorbis, map, capacity, self->channels);
     }
 
     return MA_SUCCESS;
@@ -91,23 +241,20 @@ namespace {
 
   ma_result cursor(ma_data_source* source, ma_uint64* cursor) {
     auto* self = reinterpret_cast<soundfx::stream*>(source);
-    const auto offset = op_pcm_tell(self->file);
-    if (offset < 0) [[unlikely]] {
-      return MA_ERROR;
-    }
-
-    *cursor = static_cast<ma_uint64>(offset);
+    const auto position = self->position.load(std::memory_order_relaxed);
+    *cursor = self->length != 0 ? position % self->length : position;
     return MA_SUCCESS;
   }
 
   ma_result length(ma_data_source* source, ma_uint64* length) {
     auto* self = reinterpret_cast<soundfx::stream*>(source);
-    const auto total = op_pcm_total(self->file, -1);
-    if (total < 0) [[unlikely]] {
-      return MA_ERROR;
-    }
+    *length = self->length;
+    return MA_SUCCESS;
+  }
 
-    *length = static_cast<ma_uint64>(total);
+  ma_result looping(ma_data_source* source, ma_bool32 loop) {
+    auto* self = reinterpret_cast<soundfx::stream*>(source);
+    self->looping.store(loop == MA_TRUE, std::memory_order_relaxed);
     return MA_SUCCESS;
   }
 
@@ -117,8 +264,8 @@ namespace {
     format,
     cursor,
     length,
-    nullptr,
-    0,
+    looping,
+    MA_DATA_SOURCE_SELF_MANAGED_RANGE_AND_LOOP_POINT,
   };
 
   int physfs_read(void* source, unsigned char* output, int bytes) {
@@ -166,69 +313,199 @@ namespace {
     physfs_tell,
     nullptr,
   };
-}
 
-soundfx::soundfx(std::string_view filename) {
-  _file = unwrap(
-    std::unique_ptr<PHYSFS_File, PHYSFS_Deleter>(PHYSFS_openRead(filename.data())),
-    std::format("[PHYSFS_openRead] error while opening file: {}", filename)
-  );
+  OggOpusFile* opus_open(std::string_view filename, std::unique_ptr<PHYSFS_File, PHYSFS_Deleter>& file) {
+    auto error = 0;
+    OggOpusFile* result;
+    if (const auto view = io::map(filename); !view.empty()) {
+      result = op_open_memory(view.data(), view.size(), &error);
+    } else {
+      file = unwrap(
+        std::unique_ptr<PHYSFS_File, PHYSFS_Deleter>(PHYSFS_openRead(filename.data())),
+        std::format("[PHYSFS_openRead] error while opening file: {}", filename)
+      );
+
+      result = op_open_callbacks(file.get(), &opus_callbacks, nullptr, 0, &error);
+    }
+
+    assert((error == 0)
+      && std::format("[op_open_callbacks] failed to decode: {}", filename).c_str());
 
-  auto error = 0;
-  _stream.file = op_open_callbacks(_file.get(), &opus_callbacks, nullptr, 0, &error);
+    return result;
+  }
 
-  assert((error == 0)
-    && std::format("[op_open_callbacks] failed to decode: {}", filename).c_str());
+  std::pair<std::shared_ptr<soundfx::pcm>, size_t> decode(OggOpusFile* file) {
+    auto result = std::make_shared<soundfx::pcm>();
+    result->channels = static_cast<uint32_t>(op_channel_count(file, -1));
+    result->samples.resize(static_cast<size_t>(op_pcm_total(file, -1)) * result->channels);
 
-  auto config = ma_data_source_config_init();
-  config.vtable = &vtable;
-  ma_data_source_init(&config, &_stream.base);
+    auto total = 0uz;
+    while (total < result->samples.size()) {
+      const auto request = static_cast<int>(std::min<size_t>(
+        result->samples.size() - total,
+        static_cast<size_t>(std::numeric_limits<int>::max())
+      ));
 
-  ma_sound_init_from_data_source(
-    audioengine,
-    &_stream.base,
-    MA_SOUND_FLAG_NO_SPATIALIZATION | MA_SOUND_FLAG_NO_PITCH,
-    nullptr,
-    &_sound
-  );
+      const int decoded = op_read(file, result->samples.data() + total, request, nullptr);
+      if (decoded == OP_HOLE) [[unlikely]] {
+        continue;
+      }
+
+      if (decoded <= 0) [[unlikely]] {
+        break;
+      }
 
-  ma_sound_set_end_callback(&_sound, [](void* ptr, ma_sound*) {
-    static_cast<soundfx*>(ptr)->_ended.store(true, std::memory_order_release);
-  }, this);
+      total += static_cast<size_t>(decoded) * result->channels;
+    }
+
+    result->samples.resize(total);
+    result->frames = total / result->channels;
+
+    const auto stride = static_cast<size_t>(ENVELOPE_FRAMES) * result->channels;
+    result->envelope.reserve((total + stride - 1) / stride);
+    for (auto offset = 0uz; offset < total; offset += stride) {
+      const auto block = std::span(result->samples).subspan(offset, std::min(stride, total - offset));
+      auto peak = 0;
+      for (const auto sample : block) {
+        peak = std::max(peak, std::abs(static_cast<int>(sample)));
+      }
+
+      result->envelope.emplace_back(static_cast<uint16_t>(peak));
+    }
+
+    const auto cost = sizeof(soundfx::pcm) + result->samples.size() * sizeof(int16_t) + result->envelope.size() * sizeof(uint16_t);
+    return {std::move(result), cost};
+  }
+}
+
+soundfx::soundfx(std::string_view filename, assetmanager& assets) {
+  stopwatch watch(stage::audio, filename);
+
+  if (assets.contains(filename)) {
+    _pcm = assets.acquire(filename, [&] {
+      std::unique_ptr<PHYSFS_File, PHYSFS_Deleter> file;
+      auto* const opus = opus_open(filename, file);
+      auto result = decode(opus);
+      op_free(opus);
+      return result;
+    });
+  } else {
+    auto* const opus = opus_open(filename, _file);
+    if (const auto total = op_pcm_total(opus, -1); total >= 0 && static_cast<uint64_t>(total) <= cliplength) {
+      _pcm = assets.acquire(filename, [opus] { return decode(opus); });
+      op_free(opus);
+      _file.reset();
+    } else {
+      _stream.file = opus;
+      _stream.channels = static_cast<uint32_t>(op_channel_count(opus, -1));
+      _stream.length = static_cast<uint64_t>(std::max<ogg_int64_t>(total, 0));
+    }
+  }
+
+  if (!_pcm) {
+    auto config = ma_data_source_config_init();
+    config.vtable = &vtable;
+    ma_data_source_init(&config, &_stream.base);
+    ma_pcm_rb_init(ma_format_f32, _stream.channels, RING_FRAMES, nullptr, nullptr, &_stream.ring);
+    fill(_stream);
+
+#ifndef EMSCRIPTEN
+    decoders().add(&_stream);
+#endif
+  }
+
+  const auto count = _pcm ? std::max<size_t>(polyphony, 1) : 1uz;
+  _voices.reserve(count);
+  for (auto i = 0uz; i < count; ++i) {
+    auto& v = *_voices.emplace_back(std::make_unique<voice>());
+
+    ma_data_source* source = &_stream.base;
+    if (_pcm) {
+      auto config = ma_audio_buffer_config_init(ma_format_s16, _pcm->channels, _pcm->frames, _pcm->samples.data(), nullptr);
+      config.sampleRate = SAMPLE_RATE;
+      ma_audio_buffer_init(&config, &v.buffer);
+      source = &v.buffer;
+      v.clip = _pcm.get();
+      voices.emplace_back(&v);
+    }
+
+    ma_sound_init_from_data_source(
+      audioengine,
+      source,
+      MA_SOUND_FLAG_NO_SPATIALIZATION | MA_SOUND_FLAG_NO_PITCH,
+      nullptr,
+      &v.sound
+    );
+
+    ma_sound_set_end_callback(&v.sound, [](void* ptr, ma_sound*) {
+      static_cast<soundfx*>(ptr)->_ended.store(true, std::memory_order_release);
+    }, this);
+  }
 }
 
 soundfx::~soundfx() {
-  ma_sound_set_end_callback(&_sound, nullptr, nullptr);
-  ma_sound_stop(&_sound);
-  ma_sound_uninit(&_sound);
+  for (auto& v : _voices) {
+    ma_sound_set_end_callback(&v->sound, nullptr, nullptr);
+    ma_sound_stop(&v->sound);
+    ma_sound_uninit(&v->sound);
+
+    if (_pcm) {
+      ma_audio_buffer_uninit(&v->buffer);
+      std::erase(voices, v.get());
+    }
+  }
+
+  if (_pcm) {
+    return;
+  }
+
+#ifndef EMSCRIPTEN
+  decoders().remove(&_stream);
+#endif
+
   ma_data_source_uninit(&_stream.base);
+  ma_pcm_rb_uninit(&_stream.ring);
   op_free(_stream.file);
 }
 
 void soundfx::play(bool loop) {
   _ended.store(false, std::memory_order_relaxed);
-  ma_sound_seek_to_pcm_frame(&_sound, 0);
-  ma_sound_set_looping(&_sound, loop ? MA_TRUE : MA_FALSE);
-  ma_sound_start(&_sound);
+
+  auto& v = pick();
+  ma_sound_seek_to_pcm_frame(&v.sound, 0);
+  ma_sound_set_looping(&v.sound, loop ? MA_TRUE : MA_FALSE);
+  v.started = ++sequence;
+  ma_sound_start(&v.sound);
   _onbegin();
 }
 
 void soundfx::stop() noexcept {
-  ma_sound_stop(&_sound);
+  for (auto& v : _voices) {
+    ma_sound_stop(&v->sound);
+  }
 }
 
 void soundfx::update(float delta) {
-  if (_ended.exchange(false, std::memory_order_acquire)) {
-    _onend();
+  if (!_ended.exchange(false, std::memory_order_acquire)) [[likely]] {
+    return;
   }
+
+  if (std::ranges::any_of(_voices, [](const auto& v) { return busy(*v); })) {
+    return;
+  }
+
+  _onend();
 }
 
 void soundfx::set_volume(float gain) noexcept {
-  ma_sound_set_volume(&_sound, std::clamp(gain, .0f, 1.0f));
+  _volume = std::clamp(gain, .0f, 1.0f);
+  for (auto& v : _voices) {
+    ma_sound_set_volume(&v->sound, _volume);
+  }
 }
 
 float soundfx::volume() const noexcept {
-  return ma_sound_get_volume(&_sound);
+  return _volume;
 }
 
 void soundfx::set_onbegin(sol::protected_function callback) {
@@ -238,3 +515,53 @@ void soundfx::set_onbegin(sol::protected_function callback) {
 void soundfx::set_onend(sol::protected_function callback) {
   _onend = std::move(callback);
 }
+
+void soundfx::set_policy(voicepolicy policy) noexcept {
+  _policy = policy;
+}
+
+voicepolicy soundfx::policy() const noexcept {
+  return _policy;
+}
+
+void soundfx::set_cliplength(uint32_t milliseconds) noexcept {
+  cliplength = static_cast<uint64_t>(milliseconds) * SAMPLE_RATE / 1000;
+}
+
+void soundfx::set_polyphony(uint8_t count) noexcept {
+  polyphony = count;
+}
+
+void soundfx::set_voicelimit(uint32_t count) noexcept {
+  voicelimit = count;
+}
+
+soundfx::voice& soundfx::pick() noexcept {
+  const auto idle = std::ranges::find_if(_voices, [](const auto& v) { return !busy(*v); });
+  auto& chosen = idle != _voices.end()
+    ? **idle
+    : **std::ranges::min_element(_voices, [this](const auto& lhs, const auto& rhs) { return preferable(*lhs, *rhs, _policy); });
+
+  if (!_pcm || voicelimit == 0) {
+    return chosen;
+  }
+
+  auto playing = 0uz;
+  voice* victim = nullptr;
+  for (auto* const other : voices) {
+    if (other == &chosen || !busy(*other)) {
+      continue;
+    }
+
+    ++playing;
+    if (!victim || preferable(*other, *victim, _policy)) {
+      victim = other;
+    }
+  }
+
+  if (victim && playing >= voicelimit) {
+    ma_sound_stop(&victim->sound);
+  }
+
+  return chosen;
+}
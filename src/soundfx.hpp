@@ -4,14 +4,47 @@
 
 struct OggOpusFile;
 
+enum class voicepolicy : uint8_t {
+  oldest,
+  quietest
+};
+
 class soundfx final {
 public:
   struct stream final {
     ma_data_source_base base{};
     OggOpusFile* file{nullptr};
+    ma_pcm_rb ring{};
+    uint32_t channels{0};
+    uint64_t length{0};
+
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint32_t> acknowledged{0};
+    std::atomic<uint64_t> target{0};
+    std::atomic<uint64_t> stale{0};
+    std::atomic<uint64_t> position{0};
+    std::atomic<bool> looping{false};
+    std::atomic<bool> eof{false};
+
+    uint64_t committed{0};
+    uint64_t consumed{0};
+  };
+
+  struct pcm final {
+    std::vector<int16_t> samples;
+    std::vector<uint16_t> envelope;
+    uint32_t channels{0};
+    uint64_t frames{0};
   };
 
-  explicit soundfx(std::string_view filename);
+  struct voice final {
+    ma_audio_buffer buffer{};
+    ma_sound sound{};
+    const pcm* clip{nullptr};
+    uint64_t started{0};
+  };
+
+  soundfx(std::string_view filename, assetmanager& assets);
   ~soundfx();
 
   soundfx(const soundfx&) = delete;
@@ -30,10 +63,22 @@ public:
   void set_onbegin(sol::protected_function callback);
   void set_onend(sol::protected_function callback);
 
+  void set_policy(voicepolicy policy) noexcept;
+  voicepolicy policy() const noexcept;
+
+  static void set_cliplength(uint32_t milliseconds) noexcept;
+  static void set_polyphony(uint8_t count) noexcept;
+  static void set_voicelimit(uint32_t count) noexcept;
+
 private:
+  voice& pick() noexcept;
+
   std::unique_ptr<PHYSFS_File, PHYSFS_Deleter> _file;
   stream _stream{};
-  ma_sound _sound{};
+  std::shared_ptr<const pcm> _pcm;
+  std::vector<std::unique_ptr<voice>> _voices;
+  float _volume{1.0f};
+  voicepolicy _policy{voicepolicy::oldest};
 
   functor _onbegin;
   functor _onend;
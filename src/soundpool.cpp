@@ -2,8 +2,9 @@
 
 #include "soundfx.hpp"
 
-soundpool::soundpool(std::string_view scenename)
-    : _scenename(scenename) {
+soundpool::soundpool(std::string_view scenename, assetmanager& assets)
+    : _scenename(scenename),
+      _assets(assets) {
   _sounds.reserve(8);
 }
 
@@ -14,7 +15,7 @@ soundpool::~soundpool() noexcept {
 void soundpool::add(std::string_view name) {
   auto [it, inserted] = _sounds.try_emplace(name);
   if (inserted) {
-    it->second = std::make_shared<soundfx>(std::format("blobs/{}/{}.opus", _scenename, name));
+    it->second = std::make_shared<soundfx>(std::format("blobs/{}/{}.opus", _scenename, name), _assets);
   }
 }
 
@@ -4,7 +4,7 @@
 
 class soundpool final {
 public:
-  soundpool(std::string_view scenename);
+  soundpool(std::string_view scenename, assetmanager& assets);
   ~soundpool() noexcept;
 
   void add(std::string_view name);
@@ -19,5 +19,6 @@ public:
 
 private:
   std::string _scenename;
+  assetmanager& _assets;
   boost::unordered_flat_map<std::string, std::shared_ptr<soundfx>, transparent_string_hash, std::equal_to<>> _sounds;
 };
@@ -0,0 +1,178 @@
+#include "stopwatch.hpp"
+
+#ifdef DEVELOPMENT
+namespace {
+constexpr std::array<std::string_view, 9> stages{
+  "read", "parse", "decode", "upload", "audio", "compile", "execute", "body", "collider"
+};
+
+constexpr std::array<std::string_view, 1> counters{
+  "underrun"
+};
+
+constexpr auto TOP_ENTRIES = 10uz;
+
+struct row final {
+  stage kind;
+  std::string_view path;
+  uint64_t ticks{0};
+  uint32_t count{0};
+};
+
+std::mutex mutex;
+std::atomic<uint32_t> sessions{0};
+std::forward_list<stopwatch::sample> samples;
+std::array<std::atomic<uint64_t>, counters.size()> tallies{};
+
+double milliseconds(uint64_t ticks) noexcept {
+  return static_cast<double>(ticks) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+std::string escape(std::string_view value) {
+  std::string result;
+  result.reserve(value.size());
+  for (const auto c : value) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+
+    result += c;
+  }
+
+  return result;
+}
+}
+
+stopwatch::stopwatch(stage kind, std::string_view path) {
+  if (sessions.load(std::memory_order_relaxed) == 0) [[likely]] {
+    return;
+  }
+
+  _sample.emplace_front(kind, std::string(path), 0);
+  _start = SDL_GetPerformanceCounter();
+}
+
+stopwatch::~stopwatch() noexcept {
+  if (_sample.empty()) [[likely]] {
+    return;
+  }
+
+  _sample.front().ticks = SDL_GetPerformanceCounter() - _start;
+
+  std::lock_guard lock(mutex);
+  samples.splice_after(samples.before_begin(), _sample);
+}
+
+void stopwatch::begin() noexcept {
+  sessions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void stopwatch::end() noexcept {
+  assert(sessions.load(std::memory_order_relaxed) > 0 && "unbalanced stopwatch end");
+  if (sessions.fetch_sub(1, std::memory_order_relaxed) != 1) {
+    return;
+  }
+
+  std::forward_list<sample> taken;
+  {
+    std::lock_guard lock(mutex);
+    taken.swap(samples);
+  }
+}
+
+void stopwatch::count(counter kind) noexcept {
+  tallies[static_cast<size_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void stopwatch::report(std::string_view label, double elapsed) {
+  std::vector<sample> taken;
+  {
+    std::forward_list<sample> drained;
+    {
+      std::lock_guard lock(mutex);
+      drained.swap(samples);
+    }
+
+    std::ranges::move(drained, std::back_inserter(taken));
+  }
+
+  std::ranges::sort(taken, {}, [](const sample& s) { return std::tie(s.kind, s.path); });
+
+  std::array<row, stages.size()> totals{};
+  std::vector<row> rows;
+  for (const auto& s : taken) {
+    auto& total = totals[static_cast<size_t>(s.kind)];
+    total.ticks += s.ticks;
+    ++total.count;
+
+    if (rows.empty() || rows.back().kind != s.kind || rows.back().path != s.path) {
+      rows.push_back({.kind = s.kind, .path = s.path});
+    }
+
+    rows.back().ticks += s.ticks;
+    ++rows.back().count;
+  }
+
+  std::ranges::sort(rows, std::ranges::greater{}, &row::ticks);
+
+  std::println("[stopwatch] {} took {:.3f}ms", label, elapsed);
+  for (auto i = 0uz; i < totals.size(); ++i) {
+    if (totals[i].count == 0) {
+      continue;
+    }
+
+    std::println("[stopwatch]   {:<8} {:>10.3f}ms {:>6}", stages[i], milliseconds(totals[i].ticks), totals[i].count);
+  }
+
+  std::array<uint64_t, counters.size()> counted{};
+  for (auto i = 0uz; i < counters.size(); ++i) {
+    counted[i] = tallies[i].exchange(0, std::memory_order_relaxed);
+    if (counted[i] != 0) {
+      std::println("[stopwatch]   {:<8} {:>12}", counters[i], counted[i]);
+    }
+  }
+
+  for (const auto& entry : rows | std::views::take(TOP_ENTRIES)) {
+    std::println("[stopwatch]   {:>10.3f}ms {:<8} {}", milliseconds(entry.ticks), stages[static_cast<size_t>(entry.kind)], entry.path);
+  }
+
+  const auto* const destination = std::getenv("LOADREPORT");
+  if (!destination || !*destination) {
+    return;
+  }
+
+  std::string json = std::format(R"({{"label":"{}","elapsed":{:.3f},"entries":[)", escape(label), elapsed);
+  for (auto i = 0uz; i < rows.size(); ++i) {
+    const auto& entry = rows[i];
+    json += std::format(R"({}{{"stage":"{}","path":"{}","ms":{:.3f},"count":{}}})",
+      i == 0 ? "" : ",",
+      stages[static_cast<size_t>(entry.kind)],
+      escape(entry.path),
+      milliseconds(entry.ticks),
+      entry.count);
+  }
+
+  json += R"(],"counters":{)";
+  for (auto i = 0uz; i < counters.size(); ++i) {
+    json += std::format(R"({}"{}":{})", i == 0 ? "" : ",", counters[i], counted[i]);
+  }
+
+  json += "}}\n";
+
+  std::ofstream stream(destination, std::ios::app);
+  stream << json;
+}
+#else
+void stopwatch::begin() noexcept {
+}
+
+void stopwatch::end() noexcept {
+}
+
+void stopwatch::count(counter) noexcept {
+}
+
+void stopwatch::report(std::string_view label, double elapsed) {
+  std::println("[stopwatch] {} took {:.3f}ms", label, elapsed);
+}
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common.hpp"
+
+enum class stage : uint8_t {
+  read,
+  parse,
+  decode,
+  upload,
+  audio,
+  compile,
+  execute,
+  body,
+  collider,
+};
+
+enum class counter : uint8_t {
+  underrun,
+};
+
+class stopwatch final {
+public:
+#ifdef DEVELOPMENT
+  stopwatch(stage kind, std::string_view path);
+  ~stopwatch() noexcept;
+#else
+  stopwatch(stage, std::string_view) noexcept {}
+#endif
+
+  stopwatch(const stopwatch&) = delete;
+  stopwatch& operator=(const stopwatch&) = delete;
+
+  template <typename F>
+  static decltype(auto) measure(stage kind, std::string_view path, F&& fn) {
+    stopwatch watch(kind, path);
+    return std::forward<F>(fn)();
+  }
+
+  static void begin() noexcept;
+
+  static void end() noexcept;
+
+  static void count(counter kind) noexcept;
+
+  static void report(std::string_view label, double elapsed);
+
+#ifdef DEVELOPMENT
+  struct sample final {
+    stage kind;
+    std::string path;
+    uint64_t ticks;
+  };
+
+private:
+  std::forward_list<sample> _sample;
+  uint64_t _start{0};
+#endif
+};
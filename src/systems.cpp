@@ -3,7 +3,9 @@
 #include "components.hpp"
 #include "constant.hpp"
 #include "geometry.hpp"
+#include "objectproxy.hpp"
 #include "physics.hpp"
+#include "scheduler.hpp"
 
 namespace {
 [[nodiscard]] inline const timeline* resolve_timeline(const atlas& at, symbol action) noexcept {
@@ -13,6 +15,91 @@ namespace {
 
   return at.find(action);
 }
+
+[[nodiscard]] float ease(easing curve, float t) noexcept {
+  constexpr auto pi = std::numbers::pi_v<float>;
+
+  switch (curve) {
+    case easing::linear:
+      return t;
+    case easing::quadin:
+      return t * t;
+    case easing::quadout:
+      return t * (2.f - t);
+    case easing::quadinout:
+      return t < .5f ? 2.f * t * t : 1.f - 2.f * (1.f - t) * (1.f - t);
+    case easing::cubicin:
+      return t * t * t;
+    case easing::cubicout: {
+      const auto u = 1.f - t;
+      return 1.f - u * u * u;
+    }
+    case easing::cubicinout: {
+      const auto u = 1.f - t;
+      return t < .5f ? 4.f * t * t * t : 1.f - 4.f * u * u * u;
+    }
+    case easing::sinein:
+      return 1.f - std::cos(t * pi * .5f);
+    case easing::sineout:
+      return std::sin(t * pi * .5f);
+    case easing::sineinout:
+      return .5f * (1.f - std::cos(t * pi));
+    case easing::backout: {
+      constexpr auto c1 = 1.70158f;
+      constexpr auto c3 = c1 + 1.f;
+      const auto u = t - 1.f;
+      return 1.f + c3 * u * u * u + c1 * u * u;
+    }
+    case easing::bounceout: {
+      constexpr auto n = 7.5625f;
+      constexpr auto d = 2.75f;
+      if (t < 1.f / d) return n * t * t;
+      if (t < 2.f / d) { t -= 1.5f / d; return n * t * t + .75f; }
+      if (t < 2.5f / d) { t -= 2.25f / d; return n * t * t + .9375f; }
+      t -= 2.625f / d;
+      return n * t * t + .984375f;
+    }
+  }
+
+  return t;
+}
+
+[[nodiscard]] float read(tweenable::property target, const transform& t, const tint& tn) noexcept {
+  switch (target) {
+    case tweenable::property::x:     return t.position.x;
+    case tweenable::property::y:     return t.position.y;
+    case tweenable::property::alpha: return static_cast<float>(tn.a);
+    case tweenable::property::scale: return t.scale;
+    case tweenable::property::angle: return static_cast<float>(t.angle);
+  }
+
+  return 0.f;
+}
+
+void write(tweenable::property target, float value, transform& t, tint& tn, dirtable& d) noexcept {
+  switch (target) {
+    case tweenable::property::x:
+      t.position.x = value;
+      d.mark(dirtable::render);
+      break;
+    case tweenable::property::y:
+      t.position.y = value;
+      d.mark(dirtable::render);
+      break;
+    case tweenable::property::alpha:
+      tn.a = static_cast<uint8_t>(std::clamp(std::lround(value), 0l, 255l));
+      d.mark(dirtable::physics);
+      break;
+    case tweenable::property::scale:
+      t.scale = value;
+      d.mark(dirtable::animation | dirtable::physics | dirtable::render);
+      break;
+    case tweenable::property::angle:
+      t.angle = static_cast<double>(value);
+      d.mark(dirtable::physics | dirtable::render);
+      break;
+  }
+}
 }
 
 void animationsystem::update(uint64_t now) {
@@ -77,6 +164,12 @@ void animationsystem::update(uint64_t now) {
         a->on_end();
       }
 
+      if (auto* w = _entt.try_get<awaiter>(entity)) {
+        const auto tasks = std::move(w->tasks);
+        _entt.remove<awaiter>(entity);
+        _entt.ctx().get<scheduler>().wake({tasks.data(), tasks.size()});
+      }
+
       s.finished = true;
     }
   }
@@ -129,7 +222,7 @@ void physicssystem::update(float delta) {
       const auto* m = _registry.try_get<metadata>(visitor);
 
       if (c && m) [[likely]] {
-        c->on_collision(static_cast<uint64_t>(visitor), interning.lookup(m->kind));
+        c->on_collision(objectproxy{visitor, _registry}.id(), interning.lookup(m->kind));
       }
     }
 
@@ -144,7 +237,7 @@ void physicssystem::update(float delta) {
       const auto* m = _registry.try_get<metadata>(visitor);
 
       if (c && m) [[likely]] {
-        c->on_collision_end(static_cast<uint64_t>(visitor), interning.lookup(m->kind));
+        c->on_collision_end(objectproxy{visitor, _registry}.id(), interning.lookup(m->kind));
       }
     }
   });
@@ -153,7 +246,7 @@ void physicssystem::update(float delta) {
 
   const auto& camera = *_camera;
 
-  auto sbview = _registry.view<screenboundable, const physics::body>();
+  auto sbview = _registry.view<screenboundable, const physics::body>(entt::exclude<dormant>);
   for (auto&& [entity, sb, body] : sbview.each()) {
     if (!body.has_shape()) continue;
 
@@ -214,6 +307,56 @@ void scriptsystem::update(float delta) {
   });
 }
 
+void tweensystem::update(uint64_t now) {
+  for (auto&& [entity, tw, t, tn, d] : _view.each()) {
+    auto& step = tw.steps.front();
+    if (!step.started) [[unlikely]] {
+      step.started = true;
+      step.start = now;
+      for (auto& track : step.tracks) {
+        track.from = read(track.target, t, tn);
+      }
+    }
+
+    const auto elapsed = now - step.start;
+    const auto progress = step.duration > 0 ? std::min(static_cast<float>(elapsed) / static_cast<float>(step.duration), 1.f) : 1.f;
+    const auto k = ease(step.curve, progress);
+    for (const auto& track : step.tracks) {
+      write(track.target, progress < 1.f ? track.from + (track.to - track.from) * k : track.to, t, tn, d);
+    }
+
+    if (progress < 1.f) [[likely]] {
+      continue;
+    }
+
+    if (step.on_complete) {
+      _completed.emplace_back(std::move(step.on_complete));
+    }
+
+    tw.steps.pop_front();
+    if (tw.steps.empty()) {
+      _finished.push_back(entity);
+    }
+  }
+
+  if (_finished.empty() && _completed.empty()) [[likely]] {
+    return;
+  }
+
+  for (const auto entity : _finished) {
+    if (const auto* tw = _registry.try_get<tweenable>(entity); tw && tw->steps.empty()) {
+      _registry.remove<tweenable>(entity);
+    }
+  }
+
+  _finished.clear();
+
+  auto completed = std::exchange(_completed, {});
+  for (const auto& fn : completed) {
+    fn();
+  }
+}
+
 void velocitysystem::update(float delta) {
   _view.each([delta](transform& t, const velocity& v, dirtable& d) {
     if (v.value.x == 0.f && v.value.y == 0.f) [[likely]] {
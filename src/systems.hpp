@@ -7,12 +7,12 @@
 class animationsystem final {
 public:
   explicit animationsystem(entt::registry& registry) noexcept
-    : _entt(registry), _view(registry.view<const atlas*, playback, dirtable>()) {}
+    : _entt(registry), _view(registry.view<const atlas*, playback, dirtable>(entt::exclude<dormant>)) {}
 
   void update(uint64_t now);
 
 private:
-  using view_type = decltype(std::declval<entt::registry&>().view<const atlas*, playback, dirtable>());
+  using view_type = decltype(std::declval<entt::registry&>().view<const atlas*, playback, dirtable>(entt::exclude<dormant>));
 
   entt::registry& _entt;
   view_type _view;
@@ -21,13 +21,13 @@ private:
 class physicssystem final {
 public:
   explicit physicssystem(entt::registry& registry, physics::world& world) noexcept
-    : _registry(registry), _world(world), _group(registry.group<transform, physics::body>(entt::get<playback, renderable, tint, dirtable>)) {}
+    : _registry(registry), _world(world), _group(registry.group<transform, physics::body>(entt::get<playback, renderable, tint, dirtable>, entt::exclude<dormant>)) {}
 
   void set_camera(const quad* camera) noexcept { _camera = camera; }
   void update(float delta);
 
 private:
-  using group_type = decltype(std::declval<entt::registry&>().group<transform, physics::body>(entt::get<playback, renderable, tint, dirtable>));
+  using group_type = decltype(std::declval<entt::registry&>().group<transform, physics::body>(entt::get<playback, renderable, tint, dirtable>, entt::exclude<dormant>));
 
   entt::registry& _registry;
   physics::world& _world;
@@ -39,13 +39,13 @@ class rendersystem final {
 public:
   explicit rendersystem(entt::registry& registry) noexcept
     : _registry(registry),
-      _view(registry.view<renderable, transform, tint, sprite, playback, orientation, dirtable, drawable>()) {}
+      _view(registry.view<renderable, transform, tint, sprite, playback, orientation, dirtable, drawable>(entt::exclude<dormant>)) {}
 
   void update() noexcept;
 
 private:
   using view_type = decltype(std::declval<entt::registry&>()
-    .view<renderable, transform, tint, sprite, playback, orientation, dirtable, drawable>());
+    .view<renderable, transform, tint, sprite, playback, orientation, dirtable, drawable>(entt::exclude<dormant>));
 
   entt::registry& _registry;
   view_type _view;
@@ -54,25 +54,41 @@ private:
 class scriptsystem final {
 public:
   explicit scriptsystem(entt::registry& registry) noexcept
-    : _view(registry.view<scriptable>()) {}
+    : _view(registry.view<scriptable>(entt::exclude<dormant>)) {}
 
   void update(float delta);
 
 private:
-  using view_type = decltype(std::declval<entt::registry&>().view<scriptable>());
+  using view_type = decltype(std::declval<entt::registry&>().view<scriptable>(entt::exclude<dormant>));
 
   view_type _view;
 };
 
+class tweensystem final {
+public:
+  explicit tweensystem(entt::registry& registry) noexcept
+    : _registry(registry), _view(registry.view<tweenable, transform, tint, dirtable>(entt::exclude<dormant>)) {}
+
+  void update(uint64_t now);
+
+private:
+  using view_type = decltype(std::declval<entt::registry&>().view<tweenable, transform, tint, dirtable>(entt::exclude<dormant>));
+
+  entt::registry& _registry;
+  view_type _view;
+  std::vector<entt::entity> _finished;
+  std::vector<functor> _completed;
+};
+
 class velocitysystem final {
 public:
   explicit velocitysystem(entt::registry& registry) noexcept
-    : _view(registry.view<transform, velocity, dirtable>()) {}
+    : _view(registry.view<transform, velocity, dirtable>(entt::exclude<dormant>)) {}
 
   void update(float delta);
 
 private:
-  using view_type = decltype(std::declval<entt::registry&>().view<transform, velocity, dirtable>());
+  using view_type = decltype(std::declval<entt::registry&>().view<transform, velocity, dirtable>(entt::exclude<dormant>));
 
   view_type _view;
 };
\ No newline at end of file
@@ -1,23 +1,53 @@
 #include "tilemap.hpp"
 
+#include "assetmanager.hpp"
+#include "baked.hpp"
 #include "geometry.hpp"
+#include "io.hpp"
 #include "physics.hpp"
 #include "pixmap.hpp"
+#include "stopwatch.hpp"
+
+tilemap::tilemap(std::string_view name, physics::world& world, assetmanager& assets) {
+  const auto filename = std::format("tilemaps/{}.json", name);
+  if (const auto path = baked::sibling(filename, baked::definition_extension); io::exists(path)) {
+    const auto buffer = io::read(path);
+    stopwatch watch(stage::parse, path);
+    baked::reader reader(buffer);
+
+    const auto header = reader.read<baked::tilemap>();
+    if (header.magic != baked::tilemap_magic || header.version != baked::version) [[unlikely]] {
+      throw std::runtime_error(std::format("[tilemap] invalid baked tilemap: {}", path));
+    }
 
-tilemap::tilemap(std::string_view name, physics::world& world) {
-  auto json = unmarshal::parse(io::read(std::format("tilemaps/{}.json", name)));
-
-  _tile_size = json["tile_size"].get<float>();
-  _width = json["width"].get<int32_t>();
-  _height = json["height"].get<int32_t>();
+    _tile_size = header.tile_size;
+    _width = header.width;
+    _height = header.height;
 
-  const auto layers = json["layers"];
-  _grids.reserve(layers.size());
-  layers.foreach([this](unmarshal::json node) {
-    _grids.emplace_back(std::move(node));
-  });
+    _grids.reserve(header.layers);
+    for (auto i = 0u; i < header.layers; ++i) {
+      const auto layer = reader.read<baked::layer>();
+      std::vector<uint32_t> tiles(layer.count);
+      reader.read(std::span{tiles});
+      _grids.emplace_back(std::move(tiles), layer.collider != 0);
+    }
+  } else {
+    const auto buffer = io::read(filename);
+    stopwatch watch(stage::parse, filename);
+    auto json = unmarshal::parse(buffer);
+
+    _tile_size = json["tile_size"].get<float>();
+    _width = json["width"].get<int32_t>();
+    _height = json["height"].get<int32_t>();
+
+    const auto layers = json["layers"];
+    _grids.reserve(layers.size());
+    layers.foreach([this](unmarshal::json node) {
+      _grids.emplace_back(std::move(node));
+    });
+  }
 
-  _atlas = std::make_shared<pixmap>(std::format("blobs/tilemaps/{}.png", name));
+  _atlas = assets.pixmap(std::format("blobs/tilemaps/{}.png", name));
   _tile_size = static_cast<float>(_tile_size);
   _inv_tile_size = 1.0f / _tile_size;
 
@@ -49,6 +79,7 @@ tilemap::tilemap(std::string_view name, physics::world& world) {
   const auto w = static_cast<size_t>(_width);
   const auto h = static_cast<size_t>(_height);
   const auto total = w * h;
+  stopwatch watch(stage::collider, filename);
   std::vector<uint8_t> visited(total);
   _bodies.reserve(total / 2);
 
@@ -187,9 +218,14 @@ void tilemap::draw() const noexcept {
     return;
   }
 
+  auto* const texture = static_cast<SDL_Texture*>(*_atlas);
+  if (!texture) [[unlikely]] {
+    return;
+  }
+
   SDL_RenderGeometry(
       renderer,
-      static_cast<SDL_Texture*>(*_atlas),
+      texture,
       _vertices.data(),
       static_cast<int>(_vertices.size()),
       _indices.data(),
@@ -204,3 +240,5 @@ int32_t tilemap::width() const noexcept { return _width; }
 int32_t tilemap::height() const noexcept { return _height; }
 
 float tilemap::tile_size() const noexcept { return _tile_size; }
+
+pixmap* tilemap::atlas() const noexcept { return _atlas.get(); }
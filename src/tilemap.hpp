@@ -20,11 +20,15 @@ struct alignas(64) grid final {
       tiles.emplace_back(tile.get<uint32_t>());
     });
   }
+
+  grid(std::vector<uint32_t>&& values, bool collidable) noexcept
+      : tiles(std::move(values)),
+        collider(collidable) {}
 };
 
 class tilemap final {
 public:
-  tilemap(std::string_view name, physics::world& world);
+  tilemap(std::string_view name, physics::world& world, assetmanager& assets);
 
   void set_viewport(const quad& value);
 
@@ -36,6 +40,7 @@ public:
   [[nodiscard]] int32_t width() const noexcept;
   [[nodiscard]] int32_t height() const noexcept;
   [[nodiscard]] float tile_size() const noexcept;
+  [[nodiscard]] pixmap* atlas() const noexcept;
 
 private:
   int32_t _width;
@@ -0,0 +1,58 @@
+#include "worker.hpp"
+
+namespace {
+class threadpool final {
+public:
+  threadpool() {
+    const auto count = std::clamp(SDL_GetNumLogicalCPUCores() - 1, 1, 4);
+    _threads.reserve(static_cast<size_t>(count));
+    for (auto i = 0; i < count; ++i) {
+      _threads.emplace_back([this](std::stop_token token) { run(token); });
+    }
+  }
+
+  void push(std::function<void()> job) {
+    {
+      std::lock_guard lock(_mutex);
+      _jobs.emplace_back(std::move(job));
+    }
+
+    _condition.notify_one();
+  }
+
+private:
+  void run(std::stop_token token) {
+    while (true) {
+      std::function<void()> job;
+
+      {
+        std::unique_lock lock(_mutex);
+        if (!_condition.wait(lock, token, [this] { return !_jobs.empty(); })) {
+          return;
+        }
+
+        job = std::move(_jobs.front());
+        _jobs.pop_front();
+      }
+
+      job();
+    }
+  }
+
+  std::mutex _mutex;
+  std::condition_variable_any _condition;
+  std::deque<std::function<void()>> _jobs;
+  std::vector<std::jthread> _threads;
+};
+}
+
+namespace worker {
+void enqueue(std::function<void()> job) {
+#ifdef EMSCRIPTEN
+  job();
+#else
+  static threadpool pool;
+  pool.push(std::move(job));
+#endif
+}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace worker {
+void enqueue(std::function<void()> job);
+
+template <typename F>
+[[nodiscard]] auto submit(F&& fn) -> std::future<std::invoke_result_t<F>> {
+  using R = std::invoke_result_t<F>;
+
+  auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+  auto future = task->get_future();
+  enqueue([task] { (*task)(); });
+
+  return future;
+}
+}
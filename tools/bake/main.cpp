@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <sol/sol.hpp>
+#include <spng.h>
+#include <yyjson.h>
+
+#include "baked.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+struct options final {
+  bool raw{false};
+  bool premultiply{false};
+  std::vector<fs::path> paths;
+};
+
+struct spng_deleter final {
+  void operator()(spng_ctx* ctx) const noexcept {
+    spng_ctx_free(ctx);
+  }
+};
+
+struct yyjson_deleter final {
+  void operator()(yyjson_doc* doc) const noexcept {
+    yyjson_doc_free(doc);
+  }
+};
+
+std::vector<uint8_t> slurp(const fs::path& path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error(std::format("unable to open {}", path.string()));
+  }
+
+  return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+void spit(const fs::path& path, std::span<const std::byte> header, std::span<const std::byte> payload) {
+  const auto temporary = fs::path(path).concat(".tmp");
+
+  {
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      throw std::runtime_error(std::format("unable to write {}", temporary.string()));
+    }
+
+    stream.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    stream.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+  }
+
+  fs::rename(temporary, path);
+}
+
+void texture(const fs::path& input, const options& options) {
+  const auto buffer = slurp(input);
+
+  const auto ctx = std::unique_ptr<spng_ctx, spng_deleter>(spng_ctx_new(0));
+  spng_set_png_buffer(ctx.get(), buffer.data(), buffer.size());
+
+  spng_ihdr ihdr;
+  if (const auto error = spng_get_ihdr(ctx.get(), &ihdr); error != 0) {
+    throw std::runtime_error(std::format("{}: {}", input.string(), spng_strerror(error)));
+  }
+
+  size_t length;
+  spng_decoded_image_size(ctx.get(), SPNG_FMT_RGBA8, &length);
+
+  std::vector<uint8_t> pixels(length);
+  if (const auto error = spng_decode_image(ctx.get(), pixels.data(), length, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS); error != 0) {
+    throw std::runtime_error(std::format("{}: {}", input.string(), spng_strerror(error)));
+  }
+
+  baked::texture header{
+    .width = ihdr.width,
+    .height = ihdr.height,
+  };
+
+  if (options.premultiply) {
+    header.flags |= baked::premultiplied;
+    for (auto i = 0uz; i < length; i += 4) {
+      const auto alpha = pixels[i + 3];
+      for (auto c = 0uz; c < 3; ++c) {
+        pixels[i + c] = static_cast<uint8_t>((pixels[i + c] * alpha + 127) / 255);
+      }
+    }
+  }
+
+  std::vector<uint8_t> payload;
+  if (!options.raw) {
+    payload.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(length))));
+    const auto written = LZ4_compress_HC(
+      reinterpret_cast<const char*>(pixels.data()),
+      reinterpret_cast<char*>(payload.data()),
+      static_cast<int>(length),
+      static_cast<int>(payload.size()),
+      LZ4HC_CLEVEL_MAX);
+
+    if (written > 0 && static_cast<size_t>(written) < length) {
+      payload.resize(static_cast<size_t>(written));
+      header.flags |= baked::lz4;
+    }
+  }
+
+  if (!(header.flags & baked::lz4)) {
+    payload = std::move(pixels);
+  }
+
+  header.size = static_cast<uint32_t>(payload.size());
+
+  auto output = input;
+  output.replace_extension(baked::texture_extension);
+
+  spit(output, std::as_bytes(std::span{&header, 1}), std::as_bytes(std::span{payload}));
+
+  std::println("[bake] {} -> {} ({} KiB -> {} KiB)", input.string(), output.string(), buffer.size() / 1024, (sizeof(header) + payload.size()) / 1024);
+}
+
+bool compressible(const fs::path& path) {
+  static constexpr std::array<std::string_view, 3> packed{".opus", ".png", baked::texture_extension};
+  return std::ranges::find(packed, path.extension().string()) == packed.end();
+}
+
+void cartridge(const fs::path& root, const fs::path& output) {
+  if (!fs::is_directory(root)) {
+    throw std::runtime_error(std::format("{} is not a directory", root.string()));
+  }
+
+  std::vector<fs::path> files;
+  for (const auto& entry : fs::recursive_directory_iterator(root)) {
+    if (entry.is_regular_file() && !entry.path().filename().string().starts_with('.')) {
+      files.emplace_back(entry.path());
+    }
+  }
+
+  struct item final {
+    std::string name;
+    baked::entry entry;
+  };
+
+  std::vector<item> items;
+  items.reserve(files.size());
+  for (const auto& file : files) {
+    auto name = fs::relative(file, root).generic_string();
+    const auto hash = baked::hash(name);
+    items.push_back({std::move(name), baked::entry{.hash = hash}});
+  }
+
+  std::ranges::sort(items, {}, [](const item& i) { return i.entry.hash; });
+
+  const auto temporary = fs::path(output).concat(".tmp");
+  std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+  if (!stream) {
+    throw std::runtime_error(std::format("unable to write {}", temporary.string()));
+  }
+
+  const auto pad = [&stream] {
+    const auto position = static_cast<uint64_t>(stream.tellp());
+    const auto aligned = (position + baked::cartridge_alignment - 1) / baked::cartridge_alignment * baked::cartridge_alignment;
+    const std::vector<char> zeros(aligned - position, 0);
+    stream.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    return aligned;
+  };
+
+  baked::cartridge header{.count = static_cast<uint32_t>(items.size())};
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::string names;
+  auto total = 0uz;
+  for (auto& [name, entry] : items) {
+    const auto content = slurp(root / fs::path(name));
+    std::span<const uint8_t> payload{content};
+
+    std::vector<uint8_t> compressed;
+    if (compressible(name)) {
+      compressed.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(content.size()))));
+      const auto written = LZ4_compress_HC(
+        reinterpret_cast<const char*>(content.data()),
+        reinterpret_cast<char*>(compressed.data()),
+        static_cast<int>(content.size()),
+        static_cast<int>(compressed.size()),
+        LZ4HC_CLEVEL_MAX);
+
+      if (written > 0 && static_cast<size_t>(written) < content.size() - content.size() / 8) {
+        payload = std::span<const uint8_t>{compressed}.first(static_cast<size_t>(written));
+        entry.flags |= baked::lz4;
+      }
+    }
+
+    entry.offset = pad();
+    entry.size = static_cast<uint32_t>(payload.size());
+    entry.length = static_cast<uint32_t>(content.size());
+    entry.name = static_cast<uint32_t>(names.size());
+    entry.namelength = static_cast<uint16_t>(name.size());
+    names += name;
+    total += content.size();
+
+    stream.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+  }
+
+  header.toc = pad();
+  header.namesize = static_cast<uint32_t>(names.size());
+  for (const auto& [_, entry] : items) {
+    stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  }
+
+  stream.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.close();
+
+  fs::rename(temporary, output);
+
+  std::println("[bake] {} -> {} ({} entries, {} KiB -> {} KiB)", root.string(), output.string(), items.size(), total / 1024, fs::file_size(output) / 1024);
+}
+
+std::unique_ptr<yyjson_doc, yyjson_deleter> load(const fs::path& path) {
+  auto buffer = slurp(path);
+
+  yyjson_read_err error;
+  auto* const doc = yyjson_read_opts(reinterpret_cast<char*>(buffer.data()), buffer.size(), YYJSON_READ_NOFLAG, nullptr, &error);
+  if (!doc) {
+    throw std::runtime_error(std::format("{}: {} at {}", path.string(), error.msg, error.pos));
+  }
+
+  return std::unique_ptr<yyjson_doc, yyjson_deleter>(doc);
+}
+
+float number(yyjson_val* node, const char* key, float fallback) {
+  auto* const value = yyjson_obj_get(node, key);
+  return value ? static_cast<float>(yyjson_get_num(value)) : fallback;
+}
+
+std::array<float, 4> rectangle(yyjson_val* node) {
+  return {number(node, "x", 0), number(node, "y", 0), number(node, "w", 0), number(node, "h", 0)};
+}
+
+void range(yyjson_val* node, const char* key, std::array<float, 2>& out) {
+  if (auto* const value = yyjson_obj_get(node, key)) {
+    out = {number(value, "start", out[0]), number(value, "end", out[1])};
+  }
+}
+
+template <typename T>
+void append(std::vector<std::byte>& out, std::span<const T> values) {
+  const auto bytes = std::as_bytes(values);
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+void object(const fs::path& input, yyjson_val* root) {
+  baked::object header{.scale = number(root, "scale", 1.0f)};
+
+  std::vector<baked::timeline> timelines;
+  std::vector<baked::frame> frames;
+  std::string names;
+
+  const auto name = [&names](yyjson_val* value, uint32_t& offset, uint16_t& length) {
+    offset = static_cast<uint32_t>(names.size());
+    length = static_cast<uint16_t>(yyjson_get_len(value));
+    names.append(yyjson_get_str(value), length);
+  };
+
+  size_t i, n;
+  yyjson_val *key, *node;
+  yyjson_obj_foreach(yyjson_obj_get(root, "timelines"), i, n, key, node) {
+    baked::timeline record{};
+    name(key, record.name, record.namelength);
+
+    if (yyjson_get_bool(yyjson_obj_get(node, "oneshot"))) {
+      record.flags |= baked::oneshot;
+    }
+
+    if (auto* const next = yyjson_obj_get(node, "next")) {
+      name(next, record.next, record.nextlength);
+    }
+
+    if (auto* const aabb = yyjson_obj_get(yyjson_obj_get(node, "hitbox"), "aabb")) {
+      record.flags |= baked::hitbox;
+      record.hitbox = rectangle(aabb);
+    }
+
+    record.first = static_cast<uint32_t>(frames.size());
+
+    size_t j, m;
+    yyjson_val* frame;
+    yyjson_arr_foreach(yyjson_obj_get(node, "frames"), j, m, frame) {
+      auto* const offset = yyjson_obj_get(frame, "offset");
+      frames.push_back({
+        .duration = static_cast<int32_t>(number(frame, "duration", 0)),
+        .offset_x = number(offset, "x", 0),
+        .offset_y = number(offset, "y", 0),
+        .quad = rectangle(yyjson_obj_get(frame, "quad")),
+      });
+    }
+
+    record.count = static_cast<uint32_t>(frames.size()) - record.first;
+    timelines.push_back(record);
+  }
+
+  header.timelines = static_cast<uint32_t>(timelines.size());
+  header.frames = static_cast<uint32_t>(frames.size());
+  header.namesize = static_cast<uint32_t>(names.size());
+
+  std::vector<std::byte> payload;
+  append(payload, std::span<const baked::timeline>{timelines});
+  append(payload, std::span<const baked::frame>{frames});
+  append(payload, std::span<const char>{names});
+
+  spit(baked::sibling(input.string(), baked::definition_extension), std::as_bytes(std::span{&header, 1}), payload);
+}
+
+void particle(const fs::path& input, yyjson_val* root) {
+  baked::particle header{.count = static_cast<uint32_t>(number(root, "count", 0))};
+
+  auto* const spawn = yyjson_obj_get(root, "spawn");
+  range(spawn, "x", header.xspawn);
+  range(spawn, "y", header.yspawn);
+  range(spawn, "radius", header.radius);
+  range(spawn, "angle", header.angle);
+  range(spawn, "scale", header.scale);
+  range(spawn, "life", header.life);
+
+  auto* const velocity = yyjson_obj_get(root, "velocity");
+  range(velocity, "x", header.xvel);
+  range(velocity, "y", header.yvel);
+
+  auto* const gravity = yyjson_obj_get(root, "gravity");
+  range(gravity, "x", header.gx);
+  range(gravity, "y", header.gy);
+
+  auto* const rotation = yyjson_obj_get(root, "rotation");
+  range(rotation, "force", header.rforce);
+  range(rotation, "velocity", header.rvel);
+
+  spit(baked::sibling(input.string(), baked::definition_extension), std::as_bytes(std::span{&header, 1}), {});
+}
+
+void tilemap(const fs::path& input, yyjson_val* root) {
+  baked::tilemap header{
+    .tile_size = number(root, "tile_size", 0),
+    .width = static_cast<int32_t>(number(root, "width", 0)),
+    .height = static_cast<int32_t>(number(root, "height", 0)),
+  };
+
+  std::vector<std::byte> payload;
+
+  size_t i, n;
+  yyjson_val* node;
+  yyjson_arr_foreach(yyjson_obj_get(root, "layers"), i, n, node) {
+    auto* const values = yyjson_obj_get(node, "tiles");
+
+    std::vector<uint32_t> tiles;
+    tiles.reserve(yyjson_arr_size(values));
+
+    size_t j, m;
+    yyjson_val* tile;
+    yyjson_arr_foreach(values, j, m, tile) {
+      tiles.emplace_back(static_cast<uint32_t>(yyjson_get_num(tile)));
+    }
+
+    const baked::layer layer{
+      .collider = yyjson_get_bool(yyjson_obj_get(node, "collider")) ? 1u : 0u,
+      .count = static_cast<uint32_t>(tiles.size()),
+    };
+
+    append(payload, std::span<const baked::layer>{&layer, 1});
+    append(payload, std::span<const uint32_t>{tiles});
+    ++header.layers;
+  }
+
+  spit(baked::sibling(input.string(), baked::definition_extension), std::as_bytes(std::span{&header, 1}), payload);
+}
+
+void definitions(const fs::path& root) {
+  if (!fs::is_directory(root)) {
+    throw std::runtime_error(std::format("{} is not a directory", root.string()));
+  }
+
+  using handler = void (*)(const fs::path&, yyjson_val*);
+  static constexpr std::array<std::pair<std::string_view, handler>, 3> kinds{{
+    {"objects", object},
+    {"particles", particle},
+    {"tilemaps", tilemap},
+  }};
+
+  auto count = 0uz;
+  for (const auto& [directory, fn] : kinds) {
+    if (!fs::is_directory(root / directory)) {
+      continue;
+    }
+
+    for (const auto& entry : fs::recursive_directory_iterator(root / directory)) {
+      if (!entry.is_regular_file() || entry.path().extension() != ".json") {
+        continue;
+      }
+
+      const auto doc = load(entry.path());
+      fn(entry.path(), yyjson_doc_get_root(doc.get()));
+      ++count;
+    }
+  }
+
+  std::println("[bake] {} -> {} definitions", root.string(), count);
+}
+
+void walk(const fs::path& path, std::string_view extension, const std::function<void(const fs::path&)>& fn) {
+  if (!fs::is_directory(path)) {
+    fn(path);
+    return;
+  }
+
+  for (const auto& entry : fs::recursive_directory_iterator(path)) {
+    if (entry.is_regular_file() && entry.path().extension() == extension) {
+      fn(entry.path());
+    }
+  }
+}
+
+void script(sol::state& lua, const fs::path& root, const fs::path& input) {
+  const auto buffer = slurp(input);
+  const std::string_view source{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+
+  const auto result = lua.load(source, std::format("@{}", fs::relative(input, root).generic_string()), sol::load_mode::text);
+  if (!result.valid()) {
+    const sol::error error = result;
+    throw std::runtime_error(error.what());
+  }
+
+  auto function = result.get<sol::protected_function>();
+
+  std::string bytecode;
+  function.push();
+  lua_dump(lua.lua_state(), [](lua_State*, const void* data, size_t size, void* userdata) -> int {
+    static_cast<std::string*>(userdata)->append(static_cast<const char*>(data), size);
+    return 0;
+  }, &bytecode, 0);
+  lua_pop(lua.lua_state(), 1);
+
+  spit(baked::sibling(input.string(), baked::bytecode_extension), {}, std::as_bytes(std::span{bytecode}));
+}
+
+void scripts(const fs::path& root) {
+  if (!fs::is_directory(root)) {
+    throw std::runtime_error(std::format("{} is not a directory", root.string()));
+  }
+
+  sol::state lua;
+  auto count = 0uz;
+  walk(root, ".lua", [&](const fs::path& file) {
+    script(lua, root, file);
+    ++count;
+  });
+
+  std::println("[bake] {} -> {} scripts", root.string(), count);
+}
+
+options parse(std::span<char*> arguments) {
+  options result;
+  for (std::string_view argument : arguments) {
+    if (argument == "--raw") {
+      result.raw = true;
+    } else if (argument == "--premultiply") {
+      result.premultiply = true;
+    } else {
+      result.paths.emplace_back(argument);
+    }
+  }
+
+  if (result.paths.empty()) {
+    throw std::runtime_error("no input given");
+  }
+
+  return result;
+}
+
+void usage() {
+  std::println(stderr, "usage: bake texture [--raw] [--premultiply] <file.png | directory>...");
+  std::println(stderr, "       bake definitions <directory>");
+  std::println(stderr, "       bake scripts <directory>");
+  std::println(stderr, "       bake cartridge <directory> <output.rom>");
+}
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const std::string_view command = argv[1];
+  const auto arguments = std::span{argv + 2, static_cast<size_t>(argc - 2)};
+
+  try {
+    if (command == "texture") {
+      const auto options = parse(arguments);
+      for (const auto& path : options.paths) {
+        walk(path, ".png", [&options](const fs::path& file) { texture(file, options); });
+      }
+
+      return EXIT_SUCCESS;
+    }
+
+    if (command == "definitions" && arguments.size() == 1) {
+      definitions(arguments[0]);
+      return EXIT_SUCCESS;
+    }
+
+    if (command == "scripts" && arguments.size() == 1) {
+      scripts(arguments[0]);
+      return EXIT_SUCCESS;
+    }
+
+    if (command == "cartridge" && arguments.size() == 2) {
+      cartridge(arguments[0], arguments[1]);
+      return EXIT_SUCCESS;
+    }
+  } catch (const std::exception& e) {
+    std::println(stderr, "[bake] {}", e.what());
+    return EXIT_FAILURE;
+  }
+
+  usage();
+  return EXIT_FAILURE;
+}